@@ -0,0 +1,69 @@
+#include "raylib.h"
+#include "include/qoi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define BENCH_ITERATIONS 500
+static double BenchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+static Image BenchSynthetic(void)
+{
+    Image img = GenImageGradientLinear(320, 180, 45, DARKBLUE, ORANGE);
+    ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    unsigned char *px = img.data;
+    srand(42);
+    for (int i = 0; i < img.width * img.height; i++)
+        for (int c = 0; c < 3; c++)
+        {
+            int v = px[i * 4 + c] + (rand() % 9) - 4;
+            px[i * 4 + c] = (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    return img;
+}
+int main(int argc, char **argv)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    Image src = (argc > 1) ? LoadImage(argv[1]) : BenchSynthetic();
+    if (!src.data)
+    {
+        fprintf(stderr, "Error: Could not load %s\n", argv[1]);
+        return 1;
+    }
+    ImageFormat(&src, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    int pngSize = 0;
+    unsigned char *png = ExportImageToMemory(src, ".png", &pngSize);
+    size_t qoiSize = 0;
+    uint8_t *qoi = QoiEncode(src.data, src.width, src.height, &qoiSize);
+    if (!png || !qoi)
+    {
+        fprintf(stderr, "Error: Encoding failed\n");
+        return 1;
+    }
+    double start = BenchNow();
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        Image img = LoadImageFromMemory(".png", png, pngSize);
+        UnloadImage(img);
+    }
+    double pngUs = (BenchNow() - start) * 1e6 / BENCH_ITERATIONS;
+    start = BenchNow();
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        int w, h;
+        free(QoiDecode(qoi, qoiSize, &w, &h));
+    }
+    double qoiUs = (BenchNow() - start) * 1e6 / BENCH_ITERATIONS;
+    printf("Thumbnail %dx%d, %d iterations\n", src.width, src.height, BENCH_ITERATIONS);
+    printf("  png decode: %8.1f us/item  %7d bytes\n", pngUs, pngSize);
+    printf("  qoi decode: %8.1f us/item  %7zu bytes\n", qoiUs, qoiSize);
+    printf("  speedup:    %8.1fx\n", pngUs / qoiUs);
+    MemFree(png);
+    free(qoi);
+    UnloadImage(src);
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+#include "include/main.h"
+#define ATLAS_PAGE_SIZE  2048
+#define ATLAS_SLOT_W     320
+#define ATLAS_SLOT_H     180
+#define ATLAS_SLOTS_X    (ATLAS_PAGE_SIZE / ATLAS_SLOT_W)
+#define ATLAS_SLOTS_Y    (ATLAS_PAGE_SIZE / ATLAS_SLOT_H)
+#define ATLAS_PAGE_SLOTS (ATLAS_SLOTS_X * ATLAS_SLOTS_Y)
+#define ATLAS_MAX_PAGES  64
+#define ATLAS_PAGE_BYTES ((long)ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4)
+typedef struct
+{
+    Texture2D pages[ATLAS_MAX_PAGES];
+    int       pageCount;
+    int       maxPages;
+    int32_t  *freeSlots;
+    int       freeCount;
+    int       freeCapacity;
+    uint16_t *slotW;
+    uint16_t *slotH;
+    MediaId  *owner;
+    uint32_t *lastUsed;
+} ThumbAtlas;
+void      AtlasInit(ThumbAtlas *a);
+void      AtlasUnload(ThumbAtlas *a);
+int32_t   AtlasStore(ThumbAtlas *a, Image image, MediaId owner, uint32_t frame);
+void      AtlasRelease(ThumbAtlas *a, int32_t slot);
+int32_t   AtlasLeastRecent(const ThumbAtlas *a, uint32_t before);
+Rectangle AtlasSource(const ThumbAtlas *a, int32_t slot);
+static inline Texture2D AtlasPage(const ThumbAtlas *a, int32_t slot)
+{
+    return a->pages[slot / ATLAS_PAGE_SLOTS];
+}
+static inline void AtlasTouch(ThumbAtlas *a, int32_t slot, uint32_t frame)
+{
+    a->lastUsed[slot] = frame;
+}
+#endif
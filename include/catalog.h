@@ -0,0 +1,112 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+typedef uint32_t MediaId;
+typedef int      GenreId;
+#define MEDIA_ID_NONE UINT32_MAX
+#define THUMB_SLOT_NONE (-1)
+#define MAX_GENRES    64
+#define GENRE_NONE    (-1)
+#define PLACEHOLDER_W     16
+#define PLACEHOLDER_H     9
+#define PLACEHOLDER_BYTES (PLACEHOLDER_W * PLACEHOLDER_H * 3)
+typedef struct
+{
+    const char *base;
+    uint32_t  baseLen;
+    char     *data;
+    uint32_t  len;
+    uint32_t  cap;
+    uint32_t *offsets;
+    uint32_t  count;
+    uint32_t  capacity;
+    uint32_t *slots;
+    uint32_t  slotMask;
+} StringArena;
+typedef struct
+{
+    uint64_t hash;
+    MediaId  id;
+    uint32_t refs;
+} NameSlot;
+typedef struct
+{
+    const StringArena *arena;
+    NameSlot          *slots;
+    uint32_t           mask;
+    uint32_t           count;
+} NameIndex;
+typedef struct
+{
+    StringArena *arena;
+    NameIndex   *names;
+    MediaId     *ids;
+    uint64_t    *genreBits[MAX_GENRES];
+    uint64_t    *favBits;
+    int32_t     *thumbSlots;
+    int32_t     *indexOf;
+    uint32_t     indexCap;
+    int          count;
+    int          capacity;
+    uint32_t     generation;
+} MediaLibrary;
+typedef struct
+{
+    uint8_t  *pixels;
+    uint64_t *present;
+    uint32_t  capacity;
+} PlaceholderTable;
+void        ArenaInit(StringArena *a);
+void        ArenaFree(StringArena *a);
+MediaId     ArenaIntern(StringArena *a, const char *str);
+MediaId     ArenaFind(const StringArena *a, const char *str);
+bool        ArenaAdopt(StringArena *a, const char *base, uint32_t baseLen,
+                       const uint32_t *offsets, uint32_t count);
+const char *ArenaGet(const StringArena *a, MediaId id);
+GenreId     GenreIntern(const char *name);
+GenreId     GenreFind(const char *name);
+int         GenreCount(void);
+const char *GenreName(GenreId id);
+void        NameIndexInit(NameIndex *n, const StringArena *arena);
+void        NameIndexFree(NameIndex *n);
+bool        NameIndexContains(const NameIndex *n, const char *path);
+uint64_t    NameIndexKey(const char *path);
+uint64_t   *NameIndexKeys(const NameIndex *n, uint32_t *count);
+void LibInit(MediaLibrary *lib, StringArena *arena, NameIndex *names);
+void LibFree(MediaLibrary *lib);
+int  LibAdd(MediaLibrary *lib, const char *path);
+int  LibAddId(MediaLibrary *lib, MediaId id);
+int  LibFind(const MediaLibrary *lib, const char *path);
+int  LibFindId(const MediaLibrary *lib, MediaId id);
+bool LibRemove(MediaLibrary *lib, int index);
+int  LibMove(MediaLibrary *src, int index, MediaLibrary *dst);
+void LibSetGenre(MediaLibrary *lib, int index, GenreId genre, bool on);
+void LibSetGenres(MediaLibrary *lib, int index, const char *joined);
+int  LibGenreString(const MediaLibrary *lib, int index, char *buf, int bufLen);
+void LibSetFavorite(MediaLibrary *lib, int index, bool on);
+void PlaceholderFree(PlaceholderTable *t);
+bool PlaceholderSet(PlaceholderTable *t, MediaId id, const uint8_t *rgb);
+static inline bool LibBit(const uint64_t *bits, int index)
+{
+    return bits && ((bits[index >> 6] >> (index & 63)) & 1);
+}
+static inline bool LibHasGenre(const MediaLibrary *lib, int index, GenreId genre)
+{
+    return genre >= 0 && genre < MAX_GENRES && LibBit(lib->genreBits[genre], index);
+}
+static inline bool LibIsFavorite(const MediaLibrary *lib, int index)
+{
+    return LibBit(lib->favBits, index);
+}
+static inline const uint8_t *PlaceholderGet(const PlaceholderTable *t, MediaId id)
+{
+    return (id < t->capacity && LibBit(t->present, (int)id)) ? t->pixels + (size_t)id * PLACEHOLDER_BYTES : NULL;
+}
+static inline const char *LibPath(const MediaLibrary *lib, int index)
+{
+    return ArenaGet(lib->arena, lib->ids[index]);
+}
+#endif
@@ -0,0 +1,27 @@
+#ifndef FRAME_H
+#define FRAME_H
+#include "include/main.h"
+#define FRAME_ACTIVE_FPS 60
+#define FRAME_IDLE_FPS   10
+#define FRAME_IDLE_SEC   30.0
+#define FRAME_MAX_DT     0.1f
+#define FRAME_STATS_SEC  5.0
+typedef enum
+{
+    FRAME_INPUT     = 1 << 0,
+    FRAME_ANIMATION = 1 << 1,
+    FRAME_VIDEO     = 1 << 2,
+    FRAME_IMPORT    = 1 << 3,
+    FRAME_THUMBS    = 1 << 4
+} FrameReason;
+void FrameStart(AppState *g);
+void FrameWake(AppState *g);
+void FrameInvalidate(AppState *g, unsigned reasons);
+void FrameInvalidateAt(AppState *g, double when);
+void FrameAnimate(AppState *g, double delay);
+bool FrameIdle(const AppState *g);
+void FramePoll(AppState *g);
+bool FrameBegin(AppState *g);
+void FrameMeasure(AppState *g);
+void FrameEnd(AppState *g, bool drawn);
+#endif
@@ -0,0 +1,30 @@
+#ifndef IMPORT_H
+#define IMPORT_H
+#include "include/main.h"
+#define IMPORT_ROOT           "/"
+#define IMPORT_BATCH_SIZE     256
+#define IMPORT_PUBLISH_SEC    0.1
+#define IMPORT_PROBE_QUEUE    256
+#define IMPORT_MAX_THREADS    32
+#define IMPORT_DENTS_BUFFER   (64 * 1024)
+#define IMPORT_WATCH_LIMIT    8192
+#define IMPORT_WATCH_DEPTH    16
+#define IMPORT_WATCH_BUFFER   (16 * 1024)
+typedef struct ImportBatch
+{
+    struct ImportBatch *next;
+    uint32_t  version;
+    int       count;
+    int       capacity;
+    uint8_t  *libs;
+    uint32_t *offsets;
+    char     *paths;
+    size_t    pathsLen;
+    size_t    pathsCap;
+} ImportBatch;
+void ImportAllMp4(AppState *g);
+void ImportMerge(AppState *g);
+void ImportShutdown(AppState *g);
+void ImportWatchStart(AppState *g);
+void ImportWatchStop(AppState *g);
+#endif
@@ -0,0 +1,36 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+#include "include/main.h"
+#define JOURNAL_FILE          "catalog.journal"
+#define JOURNAL_MAGIC         "MVJRNL1"
+#define JOURNAL_COMPACT_BYTES (256 * 1024)
+typedef enum
+{
+    JOURNAL_ADD = 1,
+    JOURNAL_REMOVE,
+    JOURNAL_MOVE,
+    JOURNAL_FAVORITE,
+    JOURNAL_GENRE,
+    JOURNAL_PLACEHOLDER
+} JournalOp;
+typedef struct
+{
+    uint32_t crc;
+    uint16_t length;
+    uint8_t  op;
+    uint8_t  library;
+    uint8_t  value;
+    uint8_t  reserved[3];
+} JournalRecord;
+int  JournalOpen(AppState *g);
+bool JournalFlush(AppState *g);
+void JournalCompact(AppState *g);
+void JournalReset(AppState *g);
+void JournalClose(AppState *g);
+void JournalAdd(AppState *g, MediaLibrary *lib, int index);
+void JournalRemove(AppState *g, MediaLibrary *lib, MediaId id);
+void JournalMove(AppState *g, MediaLibrary *src, MediaLibrary *dst, int index);
+void JournalFavorite(AppState *g, MediaLibrary *lib, int index);
+void JournalGenre(AppState *g, MediaLibrary *lib, int index, GenreId genre);
+void JournalPlaceholder(AppState *g, MediaLibrary *lib, int index);
+#endif
@@ -7,12 +7,14 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <cjson/cJSON.h>
 #include <mpv/client.h>
 #include <mpv/render_gl.h>
+#include "include/catalog.h"
+#include "include/query.h"
 #define SCREEN_W 1900
 #define SCREEN_H 1080
-#define MAX_MEDIA_FILES 256
 #define MAX_PATH_LENGTH PATH_MAX
 #ifndef MAX
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
@@ -32,14 +34,6 @@ typedef enum
     STATE_PLAYING
 } AppStateEnum;
 typedef struct
-{
-    char paths[MAX_MEDIA_FILES][MAX_PATH_LENGTH];
-    Texture2D thumbnails[MAX_MEDIA_FILES];
-    char genres[MAX_MEDIA_FILES][32];
-    int count;
-    bool isFavorite[MAX_MEDIA_FILES];
-} MediaLibrary;
-typedef struct
 {
     Model logoModel;
     Vector3 logoPos;
@@ -52,12 +46,35 @@ typedef struct
     AppStateEnum currentScreen;
     AppStateEnum previousScreen;
     int previewIndices[6];
+    int previewNext[6];
     double lastPreviewRefresh;
     float fadeAlpha;
     bool quit;
+    void *storeMap;
+    size_t storeMapLen;
+    long settingsJsonMtime;
+    StringArena pathArena;
+    NameIndex nameIndex;
+    PlaceholderTable placeholders;
+    pthread_mutex_t libLock;
+    int journalFd;
+    size_t journalSize;
+    size_t journalCompactAt;
+    char *journalPending;
+    size_t journalPendingLen;
+    size_t journalPendingCap;
+    pthread_t persistThread;
+    pthread_mutex_t persistLock;
+    pthread_cond_t persistCond;
+    unsigned persistDirty;
+    bool persistRunning;
+    bool persistStopping;
+    double persistFirstDirty;
+    double persistLastDirty;
     MediaLibrary movieLib;
     MediaLibrary videoLib;
     MediaLibrary musicLib;
+    MediaView gridView;
     int activeGenreIdx;
     bool isTaggingMode;
     bool selectedGenres[32];
@@ -73,6 +90,8 @@ typedef struct
     Font bubbleFont;
     int selectedIndex;
     float gridScrollOffset;
+    float gridScrollTarget;
+    int gridScrollDir;
     double lastMouseMoveTime;
     bool isSeeking;
     float seekBarAlpha;
@@ -89,17 +108,70 @@ typedef struct
     int  settingsSelectedBtn;   
     bool settingsPanelOpen;     
     int  settingsPanelIdx;
+    atomic_int settingsExport;
+    double settingsExportTime;
     bool showingMoveMenu;       
     int  moveMenuSelectedIndex; 
     int       currentTheme;       
     Texture2D darkThemeTexture;
     pthread_t      importThread;
-    volatile bool  importRunning;      
-    volatile bool  importDone;         
-    volatile int   importAdded;        
-    volatile int   importSkipped;      
-    volatile int   importTotal;        
+    bool           importRunning;
+    bool           importDone;
+    atomic_int     importAdded;
+    atomic_int     importSkipped;
+    atomic_int     importTotal;
     double         importFinishedTime; 
+    _Atomic(struct ImportBatch *) importInbox;
+    atomic_uint    importVersion;
+    atomic_bool    importFinished;
+    atomic_bool    importCancel;
+    uint32_t       importMergedVersion;
+    uint64_t      *importSeed;
+    uint32_t       importSeedCount;
+    bool           watchMedia;
+    struct ImportWatch *importWatch;
+    struct ThumbPool *thumbPool;
+    double         thumbUploadMs;
+    int            thumbUploadKB;
+    int            thumbVramMB;
+    int            thumbCacheMB;
+    unsigned       frameDirty;
+    double         frameWakeAt;
+    double         frameTickStart;
+    double         frameLastInput;
+    double         frameLastDraw;
+    float          frameDt;
+    bool           frameDrawn;
+    double         idleTimeoutSec;
+    int            idleFps;
+    pthread_mutex_t frameLock;
+    pthread_cond_t frameCond;
+    bool           frameWoken;
+    atomic_bool    playerUpdate;
+    atomic_bool    playerEvents;
+    bool           playerFrameReady;
+    bool           playerRendered;
+    bool           playerBuffering;
+    int            playerCachePercent;
+    double         playerCacheSec;
+    int            playerTrackCount;
+    int            playerAudioId;
+    int            playerSubId;
+    bool           seekPending;
+    bool           seekPendingExact;
+    bool           seekInFlight;
+    double         seekTarget;
+    double         seekIssuedAt;
+    double         seekLastStep;
+    int            seekStreak;
+    int            seekDir;
+    double         trickHoverSec;
+    bool           frameStats;
+    double         frameBlocked;
+    double         frameStatStart;
+    double         frameStatSum;
+    double         frameStatMax;
+    int            frameStatCount;
     mpv_handle *mpv;
     mpv_render_context *mpv_ctx;
 } AppState;
@@ -107,13 +179,29 @@ bool IsValidMediaFile(const char *path);
 char *OpenFileDialog(void);
 Rectangle GetButtonRect(int index);
 uint32_t simple_hash(const char *str);
+long SettingsJsonMtime(void);
 void SaveSettings(AppState *g);
 void LoadSettings(AppState *g);
+void ImportSettingsJson(AppState *g);
+bool ExportSettingsJson(AppState *g);
 void SaveUserSettings(AppState *g);
 void LoadUserSettings(AppState *g);
 void ImportAllMp4(AppState *g);
-void GenerateOrLoadThumbnail(MediaLibrary *lib, int index);
-void RefreshThumbnails(MediaLibrary *lib);
+void ImportMerge(AppState *g);
+void ImportShutdown(AppState *g);
+void ImportWatchStart(AppState *g);
+void ImportWatchStop(AppState *g);
+void ThumbStart(AppState *g);
+void ThumbRequest(AppState *g, MediaLibrary *lib, int index, int priority);
+void ThumbUpload(AppState *g);
+bool ThumbDraw(AppState *g, const MediaLibrary *lib, int index, Rectangle dest, Color tint);
+bool ThumbHasImage(const AppState *g, const MediaLibrary *lib, int index);
+void ThumbRequestSheet(AppState *g, MediaLibrary *lib, int index);
+bool ThumbDrawSheet(AppState *g, const MediaLibrary *lib, int index, Rectangle dest, Color tint);
+void ThumbRequestTrick(AppState *g, const char *path, double sec);
+bool ThumbDrawTrick(AppState *g, double sec, Rectangle dest, Color tint);
+void ThumbRelease(AppState *g, MediaLibrary *lib, int index);
+void ThumbStop(AppState *g);
 void DrawMediaGrid(AppState *g, MediaLibrary *lib, const char *title);
 void DrawMainMenu(AppState *g);
 void UpdateMainMenu(AppState *g);
@@ -122,6 +210,15 @@ void DrawGenreGrid(AppState *g);
 void DrawSettings(AppState *g);
 void UpdateSettings(AppState *g);
 void PlayVideo(AppState *g, const char *path);
+void PlayerAttach(AppState *g);
+void PlayerPoll(AppState *g);
+void PlayerSwapped(AppState *g);
+void PlayerProperty(AppState *g, const mpv_event *ev);
+void PlayerSeek(AppState *g, double target, bool exact);
+void PlayerSeekStep(AppState *g, int dir);
+void PlayerSeekUpdate(AppState *g);
+void PlayerSeekDone(AppState *g);
+double PlayerPosition(const AppState *g);
 void *get_rb_proc_address(void *ctx, const char *name);
 extern const char *GENRE_LIST[];
 extern const char *MUSIC_GENRE_LIST[];
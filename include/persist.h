@@ -0,0 +1,23 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+#include "include/main.h"
+#define PERSIST_DEBOUNCE_SEC  0.25
+#define PERSIST_MAX_DELAY_SEC 2.0
+typedef enum
+{
+    PERSIST_JOURNAL       = 1 << 0,
+    PERSIST_USER_SETTINGS = 1 << 1,
+    PERSIST_EXPORT        = 1 << 2
+} PersistFlags;
+typedef enum
+{
+    PERSIST_EXPORT_IDLE,
+    PERSIST_EXPORT_PENDING,
+    PERSIST_EXPORT_SAVED,
+    PERSIST_EXPORT_FAILED
+} PersistExportState;
+void PersistStart(AppState *g);
+void PersistMarkDirty(AppState *g, unsigned flags);
+void PersistRequestExport(AppState *g);
+void PersistStop(AppState *g);
+#endif
@@ -1,6 +1,32 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 #include "include/main.h"
+#define PLAYER_REPLY_SEEK   64
+#define PLAYER_SEEK_TIMEOUT 1.0
+#define PLAYER_SEEK_REPEAT  0.25
+#define PLAYER_SEEK_STREAK  1.0
+#define PLAYER_SEEK_ACCEL   4
+typedef enum
+{
+    PLAYER_PROP_TIME_POS = 1,
+    PLAYER_PROP_DURATION,
+    PLAYER_PROP_PAUSE,
+    PLAYER_PROP_BUFFERING,
+    PLAYER_PROP_CACHE_PERCENT,
+    PLAYER_PROP_CACHE_SEC,
+    PLAYER_PROP_TRACKS,
+    PLAYER_PROP_AID,
+    PLAYER_PROP_SID
+} PlayerProp;
 void *get_rb_proc_address(void *ctx, const char *name);
 void PlayVideo(AppState *g, const char *path);
+void PlayerAttach(AppState *g);
+void PlayerPoll(AppState *g);
+void PlayerSwapped(AppState *g);
+void PlayerProperty(AppState *g, const mpv_event *ev);
+void PlayerSeek(AppState *g, double target, bool exact);
+void PlayerSeekStep(AppState *g, int dir);
+void PlayerSeekUpdate(AppState *g);
+void PlayerSeekDone(AppState *g);
+double PlayerPosition(const AppState *g);
 #endif
\ No newline at end of file
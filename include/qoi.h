@@ -0,0 +1,11 @@
+#ifndef QOI_H
+#define QOI_H
+#include <stddef.h>
+#include <stdint.h>
+#define QOI_MAGIC       "qoif"
+#define QOI_HEADER_SIZE 14
+#define QOI_PADDING     8
+#define QOI_MAX_PIXELS  (4096 * 4096)
+uint8_t *QoiEncode(const uint8_t *rgba, int width, int height, size_t *outLen);
+uint8_t *QoiDecode(const uint8_t *data, size_t len, int *width, int *height);
+#endif
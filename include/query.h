@@ -0,0 +1,32 @@
+#ifndef QUERY_H
+#define QUERY_H
+#include "include/catalog.h"
+typedef struct
+{
+    uint64_t allOf;
+    uint64_t anyOf;
+    uint64_t noneOf;
+    bool     favoritesOnly;
+    bool     matchNone;
+} MediaFilter;
+typedef struct
+{
+    const MediaLibrary *lib;
+    MediaFilter         filter;
+    uint32_t            generation;
+    int                *items;
+    int                 count;
+    int                 capacity;
+} MediaView;
+void FilterRequireGenre(MediaFilter *f, const char *name);
+int  QueryNext(const MediaLibrary *lib, const MediaFilter *f, int from);
+int  QueryNth(const MediaLibrary *lib, const MediaFilter *f, int n);
+int  QueryCount(const MediaLibrary *lib, const MediaFilter *f);
+int  QueryGenreCount(const MediaLibrary *lib, GenreId genre);
+void ViewRefresh(MediaView *v, const MediaLibrary *lib, const MediaFilter *f);
+void ViewFree(MediaView *v);
+static inline int ViewAt(const MediaView *v, int pos)
+{
+    return (pos >= 0 && pos < v->count) ? v->items[pos] : -1;
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef SCANCACHE_H
+#define SCANCACHE_H
+#include "include/catalog.h"
+#define SCAN_CACHE_FILE    "scancache.bin"
+#define SCAN_CACHE_MAGIC   "MVSCAN1"
+#define SCAN_CACHE_VERSION 1
+#define SCAN_NONE          (-1)
+typedef struct
+{
+    uint64_t ino;
+    int64_t  mtimeNs;
+    uint64_t size;
+    double   duration;
+    int32_t  parent;
+    int32_t  firstChild;
+    int32_t  nextSibling;
+    bool     isDir;
+} ScanEntry;
+typedef struct
+{
+    StringArena paths;
+    ScanEntry  *entries;
+    uint32_t    count;
+    uint32_t    capacity;
+} ScanCache;
+typedef struct
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t stringBytes;
+    uint64_t checksum;
+} ScanCacheHeader;
+typedef struct
+{
+    uint64_t ino;
+    int64_t  mtimeNs;
+    uint64_t size;
+    double   duration;
+    int32_t  parent;
+    uint32_t path;
+    uint8_t  isDir;
+    uint8_t  reserved[7];
+} ScanCacheRecord;
+void    ScanCacheInit(ScanCache *c);
+void    ScanCacheFree(ScanCache *c);
+bool    ScanCacheLoad(ScanCache *c, const char *path);
+bool    ScanCacheSave(const ScanCache *c, const char *path);
+int32_t ScanCacheFind(const ScanCache *c, const char *path);
+int32_t ScanCacheAdd(ScanCache *c, const char *path, int32_t parent, const ScanEntry *fp);
+static inline const char *ScanCachePath(const ScanCache *c, int32_t id)
+{
+    return ArenaGet(&c->paths, (MediaId)id);
+}
+static inline bool ScanEntrySame(const ScanEntry *a, const ScanEntry *b)
+{
+    return a->ino == b->ino && a->mtimeNs == b->mtimeNs && a->isDir == b->isDir &&
+           (a->isDir || a->size == b->size);
+}
+#endif
@@ -1,8 +1,11 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 #include "include/main.h"
+long SettingsJsonMtime(void);
 void SaveSettings(AppState *g);
 void LoadSettings(AppState *g);
+void ImportSettingsJson(AppState *g);
+bool ExportSettingsJson(AppState *g);
 void SaveUserSettings(AppState *g);
 void LoadUserSettings(AppState *g);
 #endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef STORE_H
+#define STORE_H
+#include "include/main.h"
+#define CATALOG_FILE   "catalog.bin"
+#define CATALOG_MAGIC  "MVCATLG"
+#define CATALOG_VERSION 2
+typedef struct
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t checksum;
+    int64_t  jsonMtime;
+    uint32_t genreCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t recordCount;
+    uint32_t placeholderCount;
+    uint32_t reserved[3];
+} CatalogHeader;
+typedef struct
+{
+    uint32_t path;
+    uint8_t  library;
+    uint8_t  flags;
+    uint16_t reserved;
+    uint64_t genres;
+} CatalogRecord;
+#define CATALOG_RECORD_FAVORITE    0x01
+#define CATALOG_RECORD_PLACEHOLDER 0x02
+uint64_t StoreChecksum(const void *data, size_t len);
+bool     StoreLoad(AppState *g, const char *path, long jsonMtime);
+char    *StoreBuild(AppState *g, long jsonMtime, size_t *size);
+bool     StoreWrite(const char *path, const char *image, size_t size);
+bool     StoreSave(AppState *g, const char *path, long jsonMtime);
+void     StoreClose(AppState *g);
+#endif
@@ -0,0 +1,57 @@
+#ifndef THUMBCACHE_H
+#define THUMBCACHE_H
+#include "include/main.h"
+#define THUMB_CACHE_DIR       "myview"
+#define THUMB_CACHE_PACK      "thumbs.pack"
+#define THUMB_CACHE_INDEX     "thumbs.idx"
+#define THUMB_CACHE_MAGIC     "MVTHIDX"
+#define THUMB_CACHE_VERSION   3
+#define THUMB_CACHE_MB        256
+#define THUMB_CACHE_GC_TARGET 0.75
+typedef struct
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t packId;
+} ThumbCacheHeader;
+typedef struct
+{
+    uint64_t key;
+    uint64_t offset;
+    uint32_t size;
+    uint16_t width;
+    uint16_t height;
+    uint32_t lastUsed;
+    uint32_t reserved;
+} ThumbCacheRecord;
+typedef struct
+{
+    pthread_mutex_t   lock;
+    pthread_cond_t    wake;
+    pthread_t         gcThread;
+    bool              gcRunning;
+    bool              gcStopping;
+    char              packPath[PATH_MAX];
+    char              indexPath[PATH_MAX];
+    int               packFd;
+    int               indexFd;
+    uint64_t          packSize;
+    uint64_t          budget;
+    ThumbCacheRecord *entries;
+    uint32_t          count;
+    uint32_t          capacity;
+    uint32_t         *slots;
+    uint32_t          slotMask;
+    bool              dirty;
+} ThumbCache;
+bool     ThumbCacheOpen(ThumbCache *c, uint64_t budget);
+void     ThumbCacheClose(ThumbCache *c);
+uint64_t ThumbCacheKey(const char *path);
+uint64_t ThumbCacheVariant(uint64_t key, uint32_t variant);
+bool     ThumbCacheGet(ThumbCache *c, uint64_t key, Image *out);
+void     ThumbCachePut(ThumbCache *c, uint64_t key, Image image);
+bool     ThumbCacheHas(ThumbCache *c, uint64_t key);
+bool     ThumbCacheFailed(ThumbCache *c, uint64_t key);
+void     ThumbCachePutFailed(ThumbCache *c, uint64_t key);
+#endif
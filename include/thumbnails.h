@@ -1,6 +1,105 @@
 #ifndef THUMBNAILS_H
 #define THUMBNAILS_H
 #include "include/main.h"
-void GenerateOrLoadThumbnail(MediaLibrary *lib, int index);
-void RefreshThumbnails(MediaLibrary *lib);
-#endif
\ No newline at end of file
+#include "include/atlas.h"
+#include "include/thumbcache.h"
+#define THUMB_MAX_WORKERS  4
+#define THUMB_WIDTH        ATLAS_SLOT_W
+#define THUMB_HEIGHT       ATLAS_SLOT_H
+#define THUMB_SEEK_SEC     5
+#define THUMB_UPLOAD_MS    2.0
+#define THUMB_UPLOAD_KB    1024
+#define THUMB_VRAM_MB      128
+#define THUMB_CELL_W       (PLACEHOLDER_W + 2)
+#define THUMB_CELL_H       (PLACEHOLDER_H + 2)
+#define THUMB_CELL_TEX_W   1024
+#define THUMB_CELL_TEX_MAX 8192
+#define THUMB_CELL_COLS    (THUMB_CELL_TEX_W / THUMB_CELL_W)
+#define THUMB_CELL_MAX     (THUMB_CELL_TEX_MAX / THUMB_CELL_H * THUMB_CELL_COLS)
+#define THUMB_SHEET_FRAMES 8
+#define THUMB_SHEET_COLS   4
+#define THUMB_SHEET_ROWS   ((THUMB_SHEET_FRAMES + THUMB_SHEET_COLS - 1) / THUMB_SHEET_COLS)
+#define THUMB_SHEET_FPS    2.0
+#define THUMB_TRICK_SEC    10
+#define THUMB_TRICK_W      160
+#define THUMB_TRICK_H      90
+#define THUMB_TRICK_COLS   10
+#define THUMB_TRICK_ROWS   10
+#define THUMB_TRICK_FRAMES (THUMB_TRICK_COLS * THUMB_TRICK_ROWS)
+#define THUMB_JOB_FRAME    0
+#define THUMB_JOB_SHEET    1
+#define THUMB_JOB_TRICK    2
+#define THUMB_PRIORITY_VISIBLE  0
+#define THUMB_PRIORITY_PREFETCH 1
+#define THUMB_PRIORITY_TRICK    4
+#define THUMB_PREFETCH_ROWS     3
+#define THUMB_CANCEL_FRAMES     30
+#define THUMB_STATE_NONE   0
+#define THUMB_STATE_QUEUED 1
+#define THUMB_STATE_FAILED 2
+typedef struct ThumbJob
+{
+    MediaId  id;
+    char    *path;
+    int      priority;
+    uint32_t seq;
+    uint32_t frame;
+    int      kind;
+    int      part;
+} ThumbJob;
+typedef struct ThumbResult
+{
+    struct ThumbResult *next;
+    MediaId id;
+    int     kind;
+    int     part;
+    bool    cached;
+    Image   image;
+    uint8_t placeholder[PLACEHOLDER_BYTES];
+} ThumbResult;
+typedef struct ThumbPool
+{
+    pthread_t       workers[THUMB_MAX_WORKERS];
+    int             workerCount;
+    pthread_mutex_t lock;
+    pthread_cond_t  jobReady;
+    ThumbJob       *jobs;
+    int             jobCount;
+    int             jobCapacity;
+    uint32_t        jobSeq;
+    ThumbResult    *done;
+    ThumbResult    *doneTail;
+    atomic_bool     stopping;
+    uint8_t        *state;
+    uint32_t        stateCapacity;
+    ThumbAtlas      atlas;
+    ThumbCache      cache;
+    Texture2D       cells;
+    uint32_t        cellCapacity;
+    Texture2D       sheet;
+    MediaId         sheetOwner;
+    MediaId         sheetWanted;
+    double          sheetShown;
+    Texture2D       trick;
+    MediaId         trickOwner;
+    int             trickPart;
+    MediaId         trickId;
+    int             trickWanted;
+    int             trickNext;
+    bool            trickDone;
+    MediaId         trickRunningId;
+    int             trickRunning;
+    uint32_t        frame;
+} ThumbPool;
+void ThumbStart(AppState *g);
+void ThumbRequest(AppState *g, MediaLibrary *lib, int index, int priority);
+void ThumbUpload(AppState *g);
+bool ThumbDraw(AppState *g, const MediaLibrary *lib, int index, Rectangle dest, Color tint);
+bool ThumbHasImage(const AppState *g, const MediaLibrary *lib, int index);
+void ThumbRequestSheet(AppState *g, MediaLibrary *lib, int index);
+bool ThumbDrawSheet(AppState *g, const MediaLibrary *lib, int index, Rectangle dest, Color tint);
+void ThumbRequestTrick(AppState *g, const char *path, double sec);
+bool ThumbDrawTrick(AppState *g, double sec, Rectangle dest, Color tint);
+void ThumbRelease(AppState *g, MediaLibrary *lib, int index);
+void ThumbStop(AppState *g);
+#endif
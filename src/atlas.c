@@ -0,0 +1,111 @@
+#include "include/atlas.h"
+#include "rlgl.h"
+void AtlasInit(ThumbAtlas *a)
+{
+    memset(a, 0, sizeof(*a));
+    a->maxPages = ATLAS_MAX_PAGES;
+}
+void AtlasUnload(ThumbAtlas *a)
+{
+    for (int i = 0; i < a->pageCount; i++)
+        rlUnloadTexture(a->pages[i].id);
+    free(a->freeSlots);
+    free(a->slotW);
+    free(a->slotH);
+    free(a->owner);
+    free(a->lastUsed);
+    int maxPages = a->maxPages;
+    memset(a, 0, sizeof(*a));
+    a->maxPages = maxPages;
+}
+static bool AtlasAddPage(ThumbAtlas *a)
+{
+    if (a->pageCount >= MIN(a->maxPages, ATLAS_MAX_PAGES))
+        return false;
+    int slots = (a->pageCount + 1) * ATLAS_PAGE_SLOTS;
+    int32_t *freeSlots = realloc(a->freeSlots, slots * sizeof(int32_t));
+    if (freeSlots)
+        a->freeSlots = freeSlots;
+    uint16_t *slotW = realloc(a->slotW, slots * sizeof(uint16_t));
+    if (slotW)
+        a->slotW = slotW;
+    uint16_t *slotH = realloc(a->slotH, slots * sizeof(uint16_t));
+    if (slotH)
+        a->slotH = slotH;
+    MediaId *owner = realloc(a->owner, slots * sizeof(MediaId));
+    if (owner)
+        a->owner = owner;
+    uint32_t *lastUsed = realloc(a->lastUsed, slots * sizeof(uint32_t));
+    if (lastUsed)
+        a->lastUsed = lastUsed;
+    if (!freeSlots || !slotW || !slotH || !owner || !lastUsed)
+        return false;
+    unsigned int id = rlLoadTexture(NULL, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE,
+                                    PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+    if (id == 0)
+        return false;
+    a->pages[a->pageCount] = (Texture2D){id, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 1,
+                                         PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    for (int i = ATLAS_PAGE_SLOTS - 1; i >= 0; i--)
+    {
+        int32_t slot = a->pageCount * ATLAS_PAGE_SLOTS + i;
+        a->freeSlots[a->freeCount++] = slot;
+        a->owner[slot] = MEDIA_ID_NONE;
+    }
+    a->freeCapacity = slots;
+    a->pageCount++;
+    TraceLog(LOG_INFO, "Thumbnail atlas grew to %d pages", a->pageCount);
+    return true;
+}
+static Rectangle AtlasSlotRect(int32_t slot)
+{
+    int local = slot % ATLAS_PAGE_SLOTS;
+    return (Rectangle){(float)((local % ATLAS_SLOTS_X) * ATLAS_SLOT_W),
+                       (float)((local / ATLAS_SLOTS_X) * ATLAS_SLOT_H),
+                       ATLAS_SLOT_W, ATLAS_SLOT_H};
+}
+int32_t AtlasStore(ThumbAtlas *a, Image image, MediaId owner, uint32_t frame)
+{
+    if (!image.data || image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 ||
+        image.width <= 0 || image.width > ATLAS_SLOT_W ||
+        image.height <= 0 || image.height > ATLAS_SLOT_H)
+        return THUMB_SLOT_NONE;
+    if (a->freeCount == 0 && !AtlasAddPage(a))
+        return THUMB_SLOT_NONE;
+    int32_t slot = a->freeSlots[--a->freeCount];
+    Rectangle rect = AtlasSlotRect(slot);
+    rect.width = (float)image.width;
+    rect.height = (float)image.height;
+    UpdateTextureRec(AtlasPage(a, slot), rect, image.data);
+    a->slotW[slot] = (uint16_t)image.width;
+    a->slotH[slot] = (uint16_t)image.height;
+    a->owner[slot] = owner;
+    a->lastUsed[slot] = frame;
+    return slot;
+}
+void AtlasRelease(ThumbAtlas *a, int32_t slot)
+{
+    if (slot < 0 || slot >= a->pageCount * ATLAS_PAGE_SLOTS || a->owner[slot] == MEDIA_ID_NONE)
+        return;
+    a->owner[slot] = MEDIA_ID_NONE;
+    a->freeSlots[a->freeCount++] = slot;
+}
+int32_t AtlasLeastRecent(const ThumbAtlas *a, uint32_t before)
+{
+    int32_t best = THUMB_SLOT_NONE;
+    for (int32_t slot = 0; slot < a->pageCount * ATLAS_PAGE_SLOTS; slot++)
+    {
+        if (a->owner[slot] == MEDIA_ID_NONE || a->lastUsed[slot] >= before)
+            continue;
+        if (best == THUMB_SLOT_NONE || a->lastUsed[slot] < a->lastUsed[best])
+            best = slot;
+    }
+    return best;
+}
+Rectangle AtlasSource(const ThumbAtlas *a, int32_t slot)
+{
+    Rectangle rect = AtlasSlotRect(slot);
+    rect.width = a->slotW[slot];
+    rect.height = a->slotH[slot];
+    return rect;
+}
@@ -0,0 +1,560 @@
+#include "include/catalog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+static uint32_t ArenaHash(const char *str)
+{
+    uint32_t h = 2166136261u;
+    while (*str)
+    {
+        h ^= (unsigned char)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+static bool ArenaRehash(StringArena *a, uint32_t slotCount)
+{
+    uint32_t *slots = calloc(slotCount, sizeof(uint32_t));
+    if (!slots)
+        return false;
+    uint32_t mask = slotCount - 1;
+    for (uint32_t id = 0; id < a->count; id++)
+    {
+        uint32_t s = ArenaHash(ArenaGet(a, id)) & mask;
+        while (slots[s])
+            s = (s + 1) & mask;
+        slots[s] = id + 1;
+    }
+    free(a->slots);
+    a->slots = slots;
+    a->slotMask = mask;
+    return true;
+}
+void ArenaInit(StringArena *a)
+{
+    memset(a, 0, sizeof(*a));
+}
+void ArenaFree(StringArena *a)
+{
+    free(a->data);
+    free(a->offsets);
+    free(a->slots);
+    memset(a, 0, sizeof(*a));
+}
+MediaId ArenaFind(const StringArena *a, const char *str)
+{
+    if (!a->slots)
+        return MEDIA_ID_NONE;
+    uint32_t s = ArenaHash(str) & a->slotMask;
+    while (a->slots[s])
+    {
+        uint32_t id = a->slots[s] - 1;
+        if (strcmp(ArenaGet(a, id), str) == 0)
+            return id;
+        s = (s + 1) & a->slotMask;
+    }
+    return MEDIA_ID_NONE;
+}
+MediaId ArenaIntern(StringArena *a, const char *str)
+{
+    MediaId found = ArenaFind(a, str);
+    if (found != MEDIA_ID_NONE)
+        return found;
+    uint32_t size = (uint32_t)strlen(str) + 1;
+    if (a->len + size > a->cap)
+    {
+        uint32_t cap = a->cap ? a->cap : 64 * 1024;
+        while (a->len + size > cap)
+            cap *= 2;
+        char *data = realloc(a->data, cap);
+        if (!data)
+            return MEDIA_ID_NONE;
+        a->data = data;
+        a->cap = cap;
+    }
+    if (a->count == a->capacity)
+    {
+        uint32_t capacity = a->capacity ? a->capacity * 2 : 256;
+        uint32_t *offsets = realloc(a->offsets, capacity * sizeof(uint32_t));
+        if (!offsets)
+            return MEDIA_ID_NONE;
+        a->offsets = offsets;
+        a->capacity = capacity;
+    }
+    if ((a->count + 1) * 2 > (a->slots ? a->slotMask + 1 : 0))
+    {
+        uint32_t slotCount = a->slots ? (a->slotMask + 1) * 2 : 512;
+        if (!ArenaRehash(a, slotCount))
+            return MEDIA_ID_NONE;
+    }
+    MediaId id = a->count++;
+    a->offsets[id] = a->baseLen + a->len;
+    memcpy(a->data + a->len, str, size);
+    a->len += size;
+    uint32_t s = ArenaHash(str) & a->slotMask;
+    while (a->slots[s])
+        s = (s + 1) & a->slotMask;
+    a->slots[s] = id + 1;
+    return id;
+}
+const char *ArenaGet(const StringArena *a, MediaId id)
+{
+    if (id >= a->count)
+        return "";
+    uint32_t off = a->offsets[id];
+    return off < a->baseLen ? a->base + off : a->data + (off - a->baseLen);
+}
+bool ArenaAdopt(StringArena *a, const char *base, uint32_t baseLen,
+                const uint32_t *offsets, uint32_t count)
+{
+    if (a->count > 0)
+        return false;
+    uint32_t capacity = 256;
+    while (capacity < count)
+        capacity *= 2;
+    uint32_t *copy = malloc(capacity * sizeof(uint32_t));
+    if (!copy)
+        return false;
+    memcpy(copy, offsets, count * sizeof(uint32_t));
+    free(a->offsets);
+    a->offsets = copy;
+    a->capacity = capacity;
+    a->base = base;
+    a->baseLen = baseLen;
+    a->count = count;
+    uint32_t slotCount = 512;
+    while (slotCount < count * 2)
+        slotCount *= 2;
+    return ArenaRehash(a, slotCount);
+}
+static void NameKey(const char *path, const char **start, size_t *len)
+{
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    const char *dot = strrchr(name, '.');
+    *start = name;
+    *len = dot ? (size_t)(dot - name) : strlen(name);
+}
+static uint64_t NameHash(const char *key, size_t len)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)tolower((unsigned char)key[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+static bool NameEqual(const NameIndex *n, const NameSlot *slot, const char *key, size_t len)
+{
+    const char *other;
+    size_t otherLen;
+    NameKey(ArenaGet(n->arena, slot->id), &other, &otherLen);
+    return otherLen == len && strncasecmp(other, key, len) == 0;
+}
+static NameSlot *NameLookup(const NameIndex *n, const char *path)
+{
+    if (!n->slots)
+        return NULL;
+    const char *key;
+    size_t len;
+    NameKey(path, &key, &len);
+    uint64_t h = NameHash(key, len);
+    for (uint32_t s = (uint32_t)h & n->mask; n->slots[s].refs; s = (s + 1) & n->mask)
+    {
+        if (n->slots[s].hash == h && NameEqual(n, &n->slots[s], key, len))
+            return &n->slots[s];
+    }
+    return NULL;
+}
+static bool NameGrow(NameIndex *n)
+{
+    uint32_t slotCount = n->slots ? (n->mask + 1) * 2 : 1024;
+    NameSlot *slots = calloc(slotCount, sizeof(NameSlot));
+    if (!slots)
+        return false;
+    uint32_t mask = slotCount - 1;
+    for (uint32_t i = 0; n->slots && i <= n->mask; i++)
+    {
+        if (!n->slots[i].refs)
+            continue;
+        uint32_t s = (uint32_t)n->slots[i].hash & mask;
+        while (slots[s].refs)
+            s = (s + 1) & mask;
+        slots[s] = n->slots[i];
+    }
+    free(n->slots);
+    n->slots = slots;
+    n->mask = mask;
+    return true;
+}
+static void NameAdd(NameIndex *n, MediaId id)
+{
+    if (!n)
+        return;
+    const char *path = ArenaGet(n->arena, id);
+    NameSlot *slot = NameLookup(n, path);
+    if (slot)
+    {
+        slot->refs++;
+        return;
+    }
+    if ((n->count + 1) * 2 > (n->slots ? n->mask + 1 : 0) && !NameGrow(n))
+        return;
+    const char *key;
+    size_t len;
+    NameKey(path, &key, &len);
+    uint64_t h = NameHash(key, len);
+    uint32_t s = (uint32_t)h & n->mask;
+    while (n->slots[s].refs)
+        s = (s + 1) & n->mask;
+    n->slots[s] = (NameSlot){h, id, 1};
+    n->count++;
+}
+static void NameRemove(NameIndex *n, MediaId id)
+{
+    if (!n)
+        return;
+    NameSlot *slot = NameLookup(n, ArenaGet(n->arena, id));
+    if (!slot || --slot->refs > 0)
+        return;
+    uint32_t hole = (uint32_t)(slot - n->slots);
+    for (uint32_t s = (hole + 1) & n->mask; n->slots[s].refs; s = (s + 1) & n->mask)
+    {
+        uint32_t home = (uint32_t)n->slots[s].hash & n->mask;
+        if (((s - home) & n->mask) >= ((s - hole) & n->mask))
+        {
+            n->slots[hole] = n->slots[s];
+            hole = s;
+        }
+    }
+    n->slots[hole] = (NameSlot){0};
+    n->count--;
+}
+void NameIndexInit(NameIndex *n, const StringArena *arena)
+{
+    memset(n, 0, sizeof(*n));
+    n->arena = arena;
+}
+void NameIndexFree(NameIndex *n)
+{
+    free(n->slots);
+    memset(n, 0, sizeof(*n));
+}
+bool NameIndexContains(const NameIndex *n, const char *path)
+{
+    return NameLookup(n, path) != NULL;
+}
+uint64_t NameIndexKey(const char *path)
+{
+    const char *key;
+    size_t len;
+    NameKey(path, &key, &len);
+    return NameHash(key, len);
+}
+uint64_t *NameIndexKeys(const NameIndex *n, uint32_t *count)
+{
+    *count = 0;
+    uint64_t *keys = malloc((n->count ? n->count : 1) * sizeof(uint64_t));
+    if (!keys || !n->slots)
+        return keys;
+    for (uint32_t s = 0; s <= n->mask; s++)
+        if (n->slots[s].refs)
+            keys[(*count)++] = n->slots[s].hash;
+    return keys;
+}
+static char *genreNames[MAX_GENRES];
+static int   genreCount;
+GenreId GenreFind(const char *name)
+{
+    for (int i = 0; i < genreCount; i++)
+        if (strcmp(genreNames[i], name) == 0)
+            return i;
+    return GENRE_NONE;
+}
+GenreId GenreIntern(const char *name)
+{
+    GenreId id = GenreFind(name);
+    if (id != GENRE_NONE)
+        return id;
+    if (genreCount >= MAX_GENRES)
+    {
+        fprintf(stderr, "Warning: genre table full, ignoring \"%s\"\n", name);
+        return GENRE_NONE;
+    }
+    char *copy = strdup(name);
+    if (!copy)
+        return GENRE_NONE;
+    genreNames[genreCount] = copy;
+    return genreCount++;
+}
+int GenreCount(void)
+{
+    return genreCount;
+}
+const char *GenreName(GenreId id)
+{
+    return (id >= 0 && id < genreCount) ? genreNames[id] : "";
+}
+static void BitSet(uint64_t *bits, int index, bool on)
+{
+    if (on)
+        bits[index >> 6] |= 1ull << (index & 63);
+    else
+        bits[index >> 6] &= ~(1ull << (index & 63));
+}
+static void BitRemove(uint64_t *bits, int index, int count)
+{
+    if (!bits)
+        return;
+    int last = (count - 1) >> 6;
+    int w = index >> 6;
+    uint64_t low = (1ull << (index & 63)) - 1;
+    bits[w] = (bits[w] & low) | ((bits[w] >> 1) & ~low);
+    for (int k = w; k < last; k++)
+    {
+        bits[k] |= bits[k + 1] << 63;
+        bits[k + 1] >>= 1;
+    }
+}
+static uint64_t *BitGrow(uint64_t *bits, int oldCapacity, int capacity)
+{
+    uint64_t *grown = realloc(bits, (capacity / 64) * sizeof(uint64_t));
+    if (grown)
+        memset(grown + oldCapacity / 64, 0, ((capacity - oldCapacity) / 64) * sizeof(uint64_t));
+    return grown;
+}
+void LibInit(MediaLibrary *lib, StringArena *arena, NameIndex *names)
+{
+    memset(lib, 0, sizeof(*lib));
+    lib->arena = arena;
+    lib->names = names;
+}
+void LibFree(MediaLibrary *lib)
+{
+    free(lib->ids);
+    for (int i = 0; i < MAX_GENRES; i++)
+        free(lib->genreBits[i]);
+    free(lib->favBits);
+    free(lib->thumbSlots);
+    free(lib->indexOf);
+    StringArena *arena = lib->arena;
+    NameIndex *names = lib->names;
+    memset(lib, 0, sizeof(*lib));
+    lib->arena = arena;
+    lib->names = names;
+}
+static bool LibReserve(MediaLibrary *lib, int needed)
+{
+    if (needed <= lib->capacity)
+        return true;
+    int capacity = lib->capacity ? lib->capacity : 64;
+    while (capacity < needed)
+        capacity *= 2;
+    MediaId *ids = realloc(lib->ids, capacity * sizeof(*ids));
+    if (!ids)
+        return false;
+    lib->ids = ids;
+    int32_t *thumbSlots = realloc(lib->thumbSlots, capacity * sizeof(*thumbSlots));
+    if (!thumbSlots)
+        return false;
+    lib->thumbSlots = thumbSlots;
+    uint64_t *favBits = BitGrow(lib->favBits, lib->capacity, capacity);
+    if (!favBits)
+        return false;
+    lib->favBits = favBits;
+    for (int i = 0; i < MAX_GENRES; i++)
+    {
+        if (!lib->genreBits[i])
+            continue;
+        uint64_t *bits = BitGrow(lib->genreBits[i], lib->capacity, capacity);
+        if (!bits)
+            return false;
+        lib->genreBits[i] = bits;
+    }
+    lib->capacity = capacity;
+    return true;
+}
+static bool LibIndexReserve(MediaLibrary *lib, MediaId id)
+{
+    if (id >= (uint32_t)INT32_MAX)
+        return false;
+    if (id < lib->indexCap)
+        return true;
+    uint32_t capacity = lib->indexCap ? lib->indexCap : 1024;
+    while (capacity <= id)
+        capacity *= 2;
+    int32_t *indexOf = realloc(lib->indexOf, (size_t)capacity * sizeof(*indexOf));
+    if (!indexOf)
+        return false;
+    memset(indexOf + lib->indexCap, 0xff, (size_t)(capacity - lib->indexCap) * sizeof(*indexOf));
+    lib->indexOf = indexOf;
+    lib->indexCap = capacity;
+    return true;
+}
+int LibAdd(MediaLibrary *lib, const char *path)
+{
+    MediaId id = ArenaIntern(lib->arena, path);
+    if (id == MEDIA_ID_NONE)
+    {
+        fprintf(stderr, "Error: Out of memory interning %s\n", path);
+        return -1;
+    }
+    return LibAddId(lib, id);
+}
+int LibAddId(MediaLibrary *lib, MediaId id)
+{
+    int existing = LibFindId(lib, id);
+    if (existing >= 0)
+        return existing;
+    if (!LibReserve(lib, lib->count + 1) || !LibIndexReserve(lib, id))
+    {
+        fprintf(stderr, "Error: Out of memory growing media library\n");
+        return -1;
+    }
+    int idx = lib->count++;
+    lib->ids[idx]        = id;
+    lib->indexOf[id]     = idx;
+    lib->thumbSlots[idx] = THUMB_SLOT_NONE;
+    lib->generation++;
+    NameAdd(lib->names, id);
+    return idx;
+}
+int LibFind(const MediaLibrary *lib, const char *path)
+{
+    return LibFindId(lib, ArenaFind(lib->arena, path));
+}
+int LibFindId(const MediaLibrary *lib, MediaId id)
+{
+    return id < lib->indexCap ? lib->indexOf[id] : -1;
+}
+static void LibDrop(MediaLibrary *lib, int index)
+{
+    int tail = lib->count - index - 1;
+    lib->indexOf[lib->ids[index]] = -1;
+    memmove(&lib->ids[index], &lib->ids[index + 1], tail * sizeof(*lib->ids));
+    for (int i = index; i < index + tail; i++)
+        lib->indexOf[lib->ids[i]] = i;
+    memmove(&lib->thumbSlots[index], &lib->thumbSlots[index + 1], tail * sizeof(*lib->thumbSlots));
+    BitRemove(lib->favBits, index, lib->count);
+    for (int i = 0; i < MAX_GENRES; i++)
+        BitRemove(lib->genreBits[i], index, lib->count);
+    lib->count--;
+    lib->generation++;
+}
+bool LibRemove(MediaLibrary *lib, int index)
+{
+    if (index < 0 || index >= lib->count)
+        return false;
+    NameRemove(lib->names, lib->ids[index]);
+    LibDrop(lib, index);
+    return true;
+}
+int LibMove(MediaLibrary *src, int index, MediaLibrary *dst)
+{
+    if (index < 0 || index >= src->count || LibFindId(dst, src->ids[index]) >= 0 ||
+        !LibReserve(dst, dst->count + 1) || !LibIndexReserve(dst, src->ids[index]))
+        return -1;
+    int idx = dst->count++;
+    dst->generation++;
+    dst->ids[idx] = src->ids[index];
+    dst->indexOf[dst->ids[idx]] = idx;
+    dst->thumbSlots[idx] = src->thumbSlots[index];
+    LibSetFavorite(dst, idx, LibIsFavorite(src, index));
+    for (int i = 0; i < MAX_GENRES; i++)
+        if (LibBit(src->genreBits[i], index))
+            LibSetGenre(dst, idx, i, true);
+    LibDrop(src, index);
+    return idx;
+}
+void LibSetGenre(MediaLibrary *lib, int index, GenreId genre, bool on)
+{
+    if (genre < 0 || genre >= MAX_GENRES || index < 0 || index >= lib->count)
+        return;
+    if (!lib->genreBits[genre])
+    {
+        if (!on)
+            return;
+        lib->genreBits[genre] = calloc(lib->capacity / 64, sizeof(uint64_t));
+        if (!lib->genreBits[genre])
+            return;
+    }
+    BitSet(lib->genreBits[genre], index, on);
+    lib->generation++;
+}
+void LibSetGenres(MediaLibrary *lib, int index, const char *joined)
+{
+    for (int i = 0; i < MAX_GENRES; i++)
+        LibSetGenre(lib, index, i, false);
+    char name[128];
+    const char *p = joined;
+    while (*p)
+    {
+        while (*p == ',' || *p == ' ')
+            p++;
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        while (len > 0 && p[len - 1] == ' ')
+            len--;
+        if (len > 0 && len < sizeof(name))
+        {
+            memcpy(name, p, len);
+            name[len] = '\0';
+            LibSetGenre(lib, index, GenreIntern(name), true);
+        }
+        p = end ? end + 1 : p + strlen(p);
+    }
+}
+int LibGenreString(const MediaLibrary *lib, int index, char *buf, int bufLen)
+{
+    int len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < genreCount; i++)
+    {
+        if (!LibHasGenre(lib, index, i))
+            continue;
+        int n = snprintf(buf + len, bufLen - len, "%s%s", len > 0 ? ", " : "", genreNames[i]);
+        if (n < 0 || n >= bufLen - len)
+            break;
+        len += n;
+    }
+    return len;
+}
+void LibSetFavorite(MediaLibrary *lib, int index, bool on)
+{
+    if (index < 0 || index >= lib->count)
+        return;
+    BitSet(lib->favBits, index, on);
+    lib->generation++;
+}
+void PlaceholderFree(PlaceholderTable *t)
+{
+    free(t->pixels);
+    free(t->present);
+    memset(t, 0, sizeof(*t));
+}
+bool PlaceholderSet(PlaceholderTable *t, MediaId id, const uint8_t *rgb)
+{
+    if (id >= (uint32_t)INT32_MAX)
+        return false;
+    if (id >= t->capacity)
+    {
+        uint32_t capacity = t->capacity ? t->capacity : 1024;
+        while (capacity <= id)
+            capacity *= 2;
+        uint8_t *pixels = realloc(t->pixels, (size_t)capacity * PLACEHOLDER_BYTES);
+        if (!pixels)
+            return false;
+        t->pixels = pixels;
+        uint64_t *present = BitGrow(t->present, (int)t->capacity, (int)capacity);
+        if (!present)
+            return false;
+        t->present = present;
+        t->capacity = capacity;
+    }
+    memcpy(t->pixels + (size_t)id * PLACEHOLDER_BYTES, rgb, PLACEHOLDER_BYTES);
+    BitSet(t->present, (int)id, true);
+    return true;
+}
@@ -0,0 +1,117 @@
+#include "include/frame.h"
+#include <time.h>
+static bool FrameInputPending(void)
+{
+    Vector2 delta = GetMouseDelta();
+    if (delta.x != 0 || delta.y != 0 || GetMouseWheelMove() != 0 || IsWindowResized())
+        return true;
+    for (int b = MOUSE_BUTTON_LEFT; b <= MOUSE_BUTTON_BACK; b++)
+        if (IsMouseButtonDown(b) || IsMouseButtonReleased(b))
+            return true;
+    for (int k = KEY_SPACE; k <= KEY_KB_MENU; k++)
+        if (IsKeyPressed(k) || IsKeyReleased(k))
+            return true;
+    return false;
+}
+void FrameStart(AppState *g)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&g->frameLock, NULL);
+    pthread_cond_init(&g->frameCond, &attr);
+    pthread_condattr_destroy(&attr);
+    g->frameWoken = false;
+}
+void FrameWake(AppState *g)
+{
+    pthread_mutex_lock(&g->frameLock);
+    g->frameWoken = true;
+    pthread_cond_signal(&g->frameCond);
+    pthread_mutex_unlock(&g->frameLock);
+}
+void FrameInvalidate(AppState *g, unsigned reasons)
+{
+    g->frameDirty |= reasons;
+}
+void FrameInvalidateAt(AppState *g, double when)
+{
+    if (g->frameWakeAt == 0.0 || when < g->frameWakeAt)
+        g->frameWakeAt = when;
+}
+void FrameAnimate(AppState *g, double delay)
+{
+    if (!FrameIdle(g))
+        FrameInvalidateAt(g, GetTime() + MAX(delay, 0.0));
+}
+bool FrameIdle(const AppState *g)
+{
+    return GetTime() - g->frameLastInput > g->idleTimeoutSec;
+}
+void FramePoll(AppState *g)
+{
+    g->frameTickStart = GetTime();
+    g->frameBlocked = 0.0;
+    if (FrameInputPending())
+    {
+        g->frameLastInput = g->frameTickStart;
+        FrameInvalidate(g, FRAME_INPUT);
+    }
+}
+bool FrameBegin(AppState *g)
+{
+    double now = GetTime();
+    if (g->frameWakeAt != 0.0 && now >= g->frameWakeAt)
+    {
+        g->frameWakeAt = 0.0;
+        g->frameDirty |= FRAME_ANIMATION;
+    }
+    if (!g->frameDirty)
+        return false;
+    g->frameDirty = 0;
+    g->frameDt = (float)MIN(now - g->frameLastDraw, FRAME_MAX_DT);
+    g->frameLastDraw = now;
+    return true;
+}
+void FrameMeasure(AppState *g)
+{
+    if (!g->frameStats)
+        return;
+    double now = GetTime();
+    double ms = (now - g->frameTickStart - g->frameBlocked) * 1000.0;
+    if (g->frameStatCount == 0)
+        g->frameStatStart = now;
+    g->frameStatSum += ms;
+    g->frameStatMax = MAX(g->frameStatMax, ms);
+    g->frameStatCount++;
+    if (now - g->frameStatStart < FRAME_STATS_SEC)
+        return;
+    TraceLog(LOG_INFO, "Frame time: %d frames, avg %.2f ms, max %.2f ms", g->frameStatCount,
+             g->frameStatSum / g->frameStatCount, g->frameStatMax);
+    g->frameStatSum = 0.0;
+    g->frameStatMax = 0.0;
+    g->frameStatCount = 0;
+}
+void FrameEnd(AppState *g, bool drawn)
+{
+    g->frameDrawn = drawn;
+    if (drawn)
+        return;
+    PollInputEvents();
+    double tick = 1.0 / (FrameIdle(g) ? g->idleFps : FRAME_ACTIVE_FPS);
+    double wake = g->frameTickStart + tick;
+    if (g->frameWakeAt != 0.0)
+        wake = MIN(wake, g->frameWakeAt);
+    double wait = wake - GetTime();
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double due = (double)ts.tv_sec + (double)ts.tv_nsec / 1e9 + MAX(wait, 0.0);
+    ts.tv_sec = (time_t)due;
+    ts.tv_nsec = (long)((due - (double)ts.tv_sec) * 1e9);
+    pthread_mutex_lock(&g->frameLock);
+    while (!g->frameWoken && wait > 0.0)
+        if (pthread_cond_timedwait(&g->frameCond, &g->frameLock, &ts) != 0)
+            break;
+    g->frameWoken = false;
+    pthread_mutex_unlock(&g->frameLock);
+}
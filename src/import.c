@@ -0,0 +1,801 @@
+#define _GNU_SOURCE
+#include "include/import.h"
+#include "include/journal.h"
+#include "include/frame.h"
+#include "include/scancache.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <libavformat/avformat.h>
+typedef struct
+{
+    uint64_t *keys;
+    uint32_t  mask;
+    uint32_t  count;
+} ImportSeen;
+static double ImportNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+static bool ImportSeenInsert(ImportSeen *s, uint64_t key)
+{
+    if (key == 0)
+        key = 1;
+    if ((s->count + 1) * 2 > (s->keys ? s->mask + 1 : 0))
+    {
+        uint32_t slotCount = s->keys ? (s->mask + 1) * 2 : 1024;
+        uint64_t *keys = calloc(slotCount, sizeof(uint64_t));
+        if (!keys)
+            return false;
+        for (uint32_t i = 0; s->keys && i <= s->mask; i++)
+        {
+            if (!s->keys[i])
+                continue;
+            uint32_t j = (uint32_t)s->keys[i] & (slotCount - 1);
+            while (keys[j])
+                j = (j + 1) & (slotCount - 1);
+            keys[j] = s->keys[i];
+        }
+        free(s->keys);
+        s->keys = keys;
+        s->mask = slotCount - 1;
+    }
+    uint32_t i = (uint32_t)key & s->mask;
+    for (; s->keys[i]; i = (i + 1) & s->mask)
+        if (s->keys[i] == key)
+            return false;
+    s->keys[i] = key;
+    s->count++;
+    return true;
+}
+static bool ImportSeenHas(const ImportSeen *s, uint64_t key)
+{
+    if (key == 0)
+        key = 1;
+    if (!s->keys)
+        return false;
+    for (uint32_t i = (uint32_t)key & s->mask; s->keys[i]; i = (i + 1) & s->mask)
+        if (s->keys[i] == key)
+            return true;
+    return false;
+}
+static ImportBatch *ImportBatchNew(void)
+{
+    ImportBatch *b = calloc(1, sizeof(ImportBatch));
+    if (!b)
+        return NULL;
+    b->capacity = IMPORT_BATCH_SIZE;
+    b->libs = malloc(b->capacity * sizeof(*b->libs));
+    b->offsets = malloc(b->capacity * sizeof(*b->offsets));
+    b->pathsCap = 16 * 1024;
+    b->paths = malloc(b->pathsCap);
+    if (!b->libs || !b->offsets || !b->paths)
+    {
+        free(b->libs);
+        free(b->offsets);
+        free(b->paths);
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+static void ImportBatchFree(ImportBatch *b)
+{
+    free(b->libs);
+    free(b->offsets);
+    free(b->paths);
+    free(b);
+}
+static bool ImportBatchAdd(ImportBatch *b, int library, const char *path)
+{
+    size_t n = strlen(path) + 1;
+    if (b->count == b->capacity || b->pathsLen + n > UINT32_MAX)
+        return false;
+    if (b->pathsLen + n > b->pathsCap)
+    {
+        size_t cap = b->pathsCap * 2;
+        while (cap < b->pathsLen + n)
+            cap *= 2;
+        char *grown = realloc(b->paths, cap);
+        if (!grown)
+            return false;
+        b->paths = grown;
+        b->pathsCap = cap;
+    }
+    memcpy(b->paths + b->pathsLen, path, n);
+    b->libs[b->count] = (uint8_t)library;
+    b->offsets[b->count] = (uint32_t)b->pathsLen;
+    b->count++;
+    b->pathsLen += n;
+    return true;
+}
+static void ImportPublish(AppState *g, ImportBatch *b)
+{
+    b->version = atomic_fetch_add(&g->importVersion, 1) + 1;
+    ImportBatch *head = atomic_load_explicit(&g->importInbox, memory_order_relaxed);
+    do
+        b->next = head;
+    while (!atomic_compare_exchange_weak_explicit(&g->importInbox, &head, b,
+                                                  memory_order_release, memory_order_relaxed));
+}
+typedef struct
+{
+    uint64_t       d_ino;
+    int64_t        d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+} ImportDirent;
+typedef struct
+{
+    char   *path;
+    int32_t parent;
+} ImportDir;
+typedef struct
+{
+    char     *path;
+    int32_t   parent;
+    ScanEntry fp;
+} ImportFile;
+typedef struct
+{
+    AppState        *g;
+    pthread_mutex_t  lock;
+    pthread_cond_t   dirReady;
+    pthread_cond_t   fileReady;
+    pthread_cond_t   fileSpace;
+    ImportDir       *dirs;
+    int              dirCount;
+    int              dirCapacity;
+    int              busyDirs;
+    ImportFile       files[IMPORT_PROBE_QUEUE];
+    int              fileHead;
+    int              fileCount;
+    bool             walkDone;
+    ImportSeen       seen;
+    const ScanCache *old;
+    ScanCache        fresh;
+    ImportBatch     *batch;
+    double           lastPublish;
+} ImportScan;
+typedef struct ImportWatch
+{
+    AppState   *g;
+    pthread_t   thread;
+    int         fd;
+    int         wakeFd;
+    char      **dirs;
+    int         dirCapacity;
+    int         watchCount;
+} ImportWatch;
+static const char *IMPORT_PRUNE[] = {"/proc", "/sys", "/dev", "/run", "/snap", NULL};
+static bool ImportPruned(const char *path)
+{
+    for (int i = 0; IMPORT_PRUNE[i]; i++)
+        if (strcmp(path, IMPORT_PRUNE[i]) == 0)
+            return true;
+    return false;
+}
+static bool ImportIsMp4(const char *name)
+{
+    size_t n = strlen(name);
+    return n >= 4 && strcmp(name + n - 4, ".mp4") == 0;
+}
+static int ImportLibraryFor(double durSec)
+{
+    double durMin = durSec / 60.0;
+    return (durMin < 10.0) ? 2 : (durMin >= 60.0) ? 0 : 1;
+}
+static bool ImportJoinPath(char *out, size_t outLen, const char *dir, const char *name)
+{
+    int dirLen = (strcmp(dir, "/") == 0) ? 0 : (int)strlen(dir);
+    int len = snprintf(out, outLen, "%.*s/%s", dirLen, dir, name);
+    return len >= 0 && (size_t)len < outLen;
+}
+static bool ImportStatx(int dirFd, const char *path, ScanEntry *fp)
+{
+    struct statx stx;
+    if (statx(dirFd, path, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+              STATX_TYPE | STATX_INO | STATX_MTIME | STATX_SIZE, &stx) != 0)
+        return false;
+    if (!S_ISDIR(stx.stx_mode) && !S_ISREG(stx.stx_mode))
+        return false;
+    *fp = (ScanEntry){0};
+    fp->ino = stx.stx_ino;
+    fp->mtimeNs = (int64_t)stx.stx_mtime.tv_sec * 1000000000 + stx.stx_mtime.tv_nsec;
+    fp->size = stx.stx_size;
+    fp->duration = -1.0;
+    fp->isDir = S_ISDIR(stx.stx_mode);
+    return true;
+}
+static void ImportPushDir(ImportScan *s, char *dir, int32_t parent)
+{
+    pthread_mutex_lock(&s->lock);
+    if (s->dirCount == s->dirCapacity)
+    {
+        int cap = s->dirCapacity ? s->dirCapacity * 2 : 256;
+        ImportDir *grown = realloc(s->dirs, cap * sizeof(ImportDir));
+        if (!grown)
+        {
+            pthread_mutex_unlock(&s->lock);
+            free(dir);
+            return;
+        }
+        s->dirs = grown;
+        s->dirCapacity = cap;
+    }
+    s->dirs[s->dirCount++] = (ImportDir){dir, parent};
+    pthread_cond_signal(&s->dirReady);
+    pthread_mutex_unlock(&s->lock);
+}
+static void ImportCollect(ImportScan *s, const char *path, double durSec)
+{
+    pthread_mutex_lock(&s->lock);
+    if (!s->batch)
+        s->batch = ImportBatchNew();
+    if (!s->batch || !ImportSeenInsert(&s->seen, NameIndexKey(path)) || !ImportBatchAdd(s->batch, ImportLibraryFor(durSec), path))
+    {
+        pthread_mutex_unlock(&s->lock);
+        atomic_fetch_add(&s->g->importSkipped, 1);
+        return;
+    }
+    double now = ImportNow();
+    if (s->batch->count == s->batch->capacity || now - s->lastPublish >= IMPORT_PUBLISH_SEC)
+    {
+        ImportPublish(s->g, s->batch);
+        s->batch = NULL;
+        s->lastPublish = now;
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+static void ImportVisitFile(ImportScan *s, const char *path, int32_t parent, ScanEntry *fp)
+{
+    AppState *g = s->g;
+    int32_t oldId = ScanCacheFind(s->old, path);
+    if (oldId != SCAN_NONE && ScanEntrySame(&s->old->entries[oldId], fp))
+        fp->duration = s->old->entries[oldId].duration;
+    pthread_mutex_lock(&s->lock);
+    ScanCacheAdd(&s->fresh, path, parent, fp);
+    if (fp->size == 0)
+    {
+        pthread_mutex_unlock(&s->lock);
+        return;
+    }
+    atomic_fetch_add(&g->importTotal, 1);
+    bool unseen = !ImportSeenHas(&s->seen, NameIndexKey(path));
+    if (!unseen || fp->duration >= 0.0)
+    {
+        pthread_mutex_unlock(&s->lock);
+        if (unseen && fp->duration > 0.0)
+            ImportCollect(s, path, fp->duration);
+        else
+            atomic_fetch_add(&g->importSkipped, 1);
+        return;
+    }
+    while (s->fileCount == IMPORT_PROBE_QUEUE && !atomic_load(&g->importCancel))
+        pthread_cond_wait(&s->fileSpace, &s->lock);
+    char *copy = atomic_load(&g->importCancel) ? NULL : strdup(path);
+    if (copy)
+    {
+        s->files[(s->fileHead + s->fileCount) % IMPORT_PROBE_QUEUE] = (ImportFile){copy, parent, *fp};
+        s->fileCount++;
+        pthread_cond_signal(&s->fileReady);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+static void ImportScanCached(ImportScan *s, int32_t oldId, int32_t self)
+{
+    const ScanCache *old = s->old;
+    for (int32_t c = old->entries[oldId].firstChild;
+         c != SCAN_NONE && !atomic_load(&s->g->importCancel); c = old->entries[c].nextSibling)
+    {
+        const char *path = ScanCachePath(old, c);
+        if (old->entries[c].isDir)
+        {
+            char *copy = strdup(path);
+            if (copy)
+                ImportPushDir(s, copy, self);
+            continue;
+        }
+        ScanEntry fp;
+        if (ImportStatx(AT_FDCWD, path, &fp) && !fp.isDir)
+            ImportVisitFile(s, path, self, &fp);
+    }
+}
+static void ImportScanDir(ImportScan *s, const ImportDir *dir, char *buf, size_t bufLen)
+{
+    ScanEntry dirFp;
+    if (!ImportStatx(AT_FDCWD, dir->path, &dirFp) || !dirFp.isDir)
+        return;
+    int32_t oldId = ScanCacheFind(s->old, dir->path);
+    pthread_mutex_lock(&s->lock);
+    int32_t self = ScanCacheAdd(&s->fresh, dir->path, dir->parent, &dirFp);
+    pthread_mutex_unlock(&s->lock);
+    if (oldId != SCAN_NONE && ScanEntrySame(&s->old->entries[oldId], &dirFp))
+    {
+        ImportScanCached(s, oldId, self);
+        return;
+    }
+    int fd = open(dir->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    char path[MAX_PATH_LENGTH];
+    long n;
+    while (!atomic_load(&s->g->importCancel) &&
+           (n = syscall(SYS_getdents64, fd, buf, bufLen)) > 0)
+    {
+        for (long off = 0; off < n;)
+        {
+            ImportDirent *d = (ImportDirent *)(buf + off);
+            off += d->d_reclen;
+            const char *name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                continue;
+            unsigned char type = d->d_type;
+            if (type != DT_DIR && type != DT_REG && type != DT_UNKNOWN)
+                continue;
+            if (type == DT_REG && !ImportIsMp4(name))
+                continue;
+            if (!ImportJoinPath(path, sizeof(path), dir->path, name))
+                continue;
+            ScanEntry fp = {0};
+            if (type != DT_DIR)
+            {
+                if (!ImportStatx(fd, name, &fp))
+                    continue;
+                type = fp.isDir ? DT_DIR : DT_REG;
+            }
+            if (type == DT_DIR)
+            {
+                char *copy = ImportPruned(path) ? NULL : strdup(path);
+                if (copy)
+                    ImportPushDir(s, copy, self);
+            }
+            else if (ImportIsMp4(name))
+            {
+                ImportVisitFile(s, path, self, &fp);
+            }
+        }
+    }
+    close(fd);
+}
+static void *ImportWalkerFn(void *arg)
+{
+    ImportScan *s = (ImportScan *)arg;
+    size_t bufLen = IMPORT_DENTS_BUFFER;
+    char *buf = malloc(bufLen);
+    if (!buf)
+        return NULL;
+    for (;;)
+    {
+        pthread_mutex_lock(&s->lock);
+        while (s->dirCount == 0 && s->busyDirs > 0 && !atomic_load(&s->g->importCancel))
+            pthread_cond_wait(&s->dirReady, &s->lock);
+        if (s->dirCount == 0 || atomic_load(&s->g->importCancel))
+        {
+            pthread_cond_broadcast(&s->dirReady);
+            pthread_mutex_unlock(&s->lock);
+            break;
+        }
+        ImportDir dir = s->dirs[--s->dirCount];
+        s->busyDirs++;
+        pthread_mutex_unlock(&s->lock);
+        ImportScanDir(s, &dir, buf, bufLen);
+        free(dir.path);
+        pthread_mutex_lock(&s->lock);
+        s->busyDirs--;
+        if (s->busyDirs == 0 && s->dirCount == 0)
+            pthread_cond_broadcast(&s->dirReady);
+        pthread_mutex_unlock(&s->lock);
+    }
+    free(buf);
+    return NULL;
+}
+static int ImportInterrupt(void *opaque)
+{
+    return atomic_load(&((AppState *)opaque)->importCancel);
+}
+static double ImportProbeDuration(AppState *g, const char *path)
+{
+    AVFormatContext *fmt = avformat_alloc_context();
+    if (!fmt)
+        return 0.0;
+    fmt->interrupt_callback.callback = ImportInterrupt;
+    fmt->interrupt_callback.opaque = g;
+    if (avformat_open_input(&fmt, path, NULL, NULL) != 0)
+        return 0.0;
+    if (fmt->duration == AV_NOPTS_VALUE)
+        avformat_find_stream_info(fmt, NULL);
+    double durSec = (fmt->duration == AV_NOPTS_VALUE) ? 0.0 : (double)fmt->duration / AV_TIME_BASE;
+    avformat_close_input(&fmt);
+    return durSec;
+}
+static void *ImportProberFn(void *arg)
+{
+    ImportScan *s = (ImportScan *)arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&s->lock);
+        while (s->fileCount == 0 && !s->walkDone)
+            pthread_cond_wait(&s->fileReady, &s->lock);
+        if (s->fileCount == 0)
+        {
+            pthread_mutex_unlock(&s->lock);
+            break;
+        }
+        ImportFile file = s->files[s->fileHead];
+        s->fileHead = (s->fileHead + 1) % IMPORT_PROBE_QUEUE;
+        s->fileCount--;
+        pthread_cond_signal(&s->fileSpace);
+        pthread_mutex_unlock(&s->lock);
+        if (atomic_load(&s->g->importCancel))
+        {
+            free(file.path);
+            continue;
+        }
+        file.fp.duration = ImportProbeDuration(s->g, file.path);
+        pthread_mutex_lock(&s->lock);
+        ScanCacheAdd(&s->fresh, file.path, file.parent, &file.fp);
+        pthread_mutex_unlock(&s->lock);
+        if (file.fp.duration > 0.0)
+            ImportCollect(s, file.path, file.fp.duration);
+        else
+            atomic_fetch_add(&s->g->importSkipped, 1);
+        free(file.path);
+    }
+    return NULL;
+}
+static int ImportThreadCount(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (int)MAX(2, MIN(n, IMPORT_MAX_THREADS));
+}
+static void *ImportThreadFn(void *arg)
+{
+    AppState *g = (AppState *)arg;
+    ImportScan s = {0};
+    ScanCache old;
+    ScanCacheInit(&old);
+    ScanCacheLoad(&old, SCAN_CACHE_FILE);
+    s.g = g;
+    s.old = &old;
+    ScanCacheInit(&s.fresh);
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.dirReady, NULL);
+    pthread_cond_init(&s.fileReady, NULL);
+    pthread_cond_init(&s.fileSpace, NULL);
+    for (uint32_t i = 0; i < g->importSeedCount; i++)
+        ImportSeenInsert(&s.seen, g->importSeed[i]);
+    free(g->importSeed);
+    g->importSeed = NULL;
+    g->importSeedCount = 0;
+    s.lastPublish = ImportNow();
+    av_log_set_level(AV_LOG_QUIET);
+    char *root = strdup(IMPORT_ROOT);
+    if (root)
+        ImportPushDir(&s, root, SCAN_NONE);
+    int threadCount = ImportThreadCount();
+    pthread_t walkers[IMPORT_MAX_THREADS];
+    pthread_t probers[IMPORT_MAX_THREADS];
+    int walkerCount = 0, proberCount = 0;
+    for (int i = 0; i < threadCount; i++)
+        if (pthread_create(&probers[proberCount], NULL, ImportProberFn, &s) == 0)
+            proberCount++;
+    if (proberCount == 0)
+    {
+        fprintf(stderr, "ImportAllMp4: failed to start probe workers\n");
+        atomic_store(&g->importCancel, true);
+    }
+    for (int i = 0; i < threadCount && proberCount > 0; i++)
+        if (pthread_create(&walkers[walkerCount], NULL, ImportWalkerFn, &s) == 0)
+            walkerCount++;
+    if (walkerCount == 0)
+        ImportWalkerFn(&s);
+    for (int i = 0; i < walkerCount; i++)
+        pthread_join(walkers[i], NULL);
+    pthread_mutex_lock(&s.lock);
+    s.walkDone = true;
+    pthread_cond_broadcast(&s.fileReady);
+    pthread_mutex_unlock(&s.lock);
+    for (int i = 0; i < proberCount; i++)
+        pthread_join(probers[i], NULL);
+    if (s.batch)
+        ImportPublish(g, s.batch);
+    if (!atomic_load(&g->importCancel))
+        ScanCacheSave(&s.fresh, SCAN_CACHE_FILE);
+    for (int i = 0; i < s.dirCount; i++)
+        free(s.dirs[i].path);
+    free(s.dirs);
+    free(s.seen.keys);
+    ScanCacheFree(&s.fresh);
+    ScanCacheFree(&old);
+    pthread_cond_destroy(&s.fileSpace);
+    pthread_cond_destroy(&s.fileReady);
+    pthread_cond_destroy(&s.dirReady);
+    pthread_mutex_destroy(&s.lock);
+    atomic_store(&g->importFinished, true);
+    return NULL;
+}
+static void ImportWatchTree(ImportWatch *w, const char *dir, int depth);
+static void ImportWatchFile(ImportWatch *w, const char *path)
+{
+    double durSec = ImportProbeDuration(w->g, path);
+    if (durSec <= 0.0)
+        return;
+    ImportBatch *b = ImportBatchNew();
+    if (b && ImportBatchAdd(b, ImportLibraryFor(durSec), path))
+        ImportPublish(w->g, b);
+    else if (b)
+        ImportBatchFree(b);
+}
+static bool ImportWatchDir(ImportWatch *w, const char *dir)
+{
+    if (w->watchCount >= IMPORT_WATCH_LIMIT)
+        return false;
+    int wd = inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE |
+                                           IN_MOVE_SELF | IN_DELETE_SELF |
+                                           IN_ONLYDIR | IN_DONT_FOLLOW);
+    if (wd < 0)
+        return false;
+    if (wd >= w->dirCapacity)
+    {
+        int cap = w->dirCapacity ? w->dirCapacity : 256;
+        while (cap <= wd)
+            cap *= 2;
+        char **grown = realloc(w->dirs, cap * sizeof(char *));
+        if (!grown)
+            return false;
+        memset(grown + w->dirCapacity, 0, (cap - w->dirCapacity) * sizeof(char *));
+        w->dirs = grown;
+        w->dirCapacity = cap;
+    }
+    if (w->dirs[wd] && strcmp(w->dirs[wd], dir) == 0)
+        return true;
+    char *copy = strdup(dir);
+    if (!copy)
+        return false;
+    if (!w->dirs[wd])
+        w->watchCount++;
+    free(w->dirs[wd]);
+    w->dirs[wd] = copy;
+    return true;
+}
+static void ImportWatchMoved(ImportWatch *w, int wd)
+{
+    struct stat st;
+    if (stat(w->dirs[wd], &st) == 0 && S_ISDIR(st.st_mode))
+        return;
+    size_t len = strlen(w->dirs[wd]);
+    for (int i = 0; i < w->dirCapacity; i++)
+        if (w->dirs[i] && strncmp(w->dirs[i], w->dirs[wd], len) == 0 &&
+            (w->dirs[i][len] == '/' || w->dirs[i][len] == '\0'))
+            inotify_rm_watch(w->fd, i);
+}
+static void ImportWatchTree(ImportWatch *w, const char *dir, int depth)
+{
+    if (depth > IMPORT_WATCH_DEPTH || ImportPruned(dir) || !ImportWatchDir(w, dir))
+        return;
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+    struct dirent *e;
+    char path[MAX_PATH_LENGTH];
+    while ((e = readdir(d)) && !atomic_load(&w->g->importCancel))
+    {
+        if (e->d_name[0] == '.' && (e->d_name[1] == '\0' || (e->d_name[1] == '.' && e->d_name[2] == '\0')))
+            continue;
+        if (!ImportJoinPath(path, sizeof(path), dir, e->d_name))
+            continue;
+        ScanEntry fp;
+        if (!ImportStatx(AT_FDCWD, path, &fp))
+            continue;
+        if (fp.isDir)
+            ImportWatchTree(w, path, depth + 1);
+        else if (fp.size > 0 && ImportIsMp4(e->d_name))
+            ImportWatchFile(w, path);
+    }
+    closedir(d);
+}
+static void ImportWatchSeed(ImportWatch *w)
+{
+    ScanCache cache;
+    ScanCacheInit(&cache);
+    if (!ScanCacheLoad(&cache, SCAN_CACHE_FILE))
+        ImportWatchDir(w, IMPORT_ROOT);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t i = 0; i < cache.count; i++)
+        {
+            const ScanEntry *e = &cache.entries[i];
+            if (!e->isDir)
+                continue;
+            bool hasMedia = false;
+            for (int32_t c = e->firstChild; c != SCAN_NONE && !hasMedia; c = cache.entries[c].nextSibling)
+                hasMedia = !cache.entries[c].isDir && cache.entries[c].duration > 0.0;
+            if (hasMedia == (pass == 0))
+                ImportWatchDir(w, ScanCachePath(&cache, (int32_t)i));
+        }
+    }
+    ScanCacheFree(&cache);
+    TraceLog(LOG_INFO, "Watching %d directories for new media", w->watchCount);
+}
+static void *ImportWatchFn(void *arg)
+{
+    ImportWatch *w = (ImportWatch *)arg;
+    ImportWatchSeed(w);
+    char buf[IMPORT_WATCH_BUFFER] __attribute__((aligned(__alignof__(struct inotify_event))));
+    char path[MAX_PATH_LENGTH];
+    struct pollfd fds[2] = {{w->fd, POLLIN, 0}, {w->wakeFd, POLLIN, 0}};
+    for (;;)
+    {
+        int ready = poll(fds, 2, -1);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready < 0)
+            fprintf(stderr, "Error: Media watcher stopped: %s\n", strerror(errno));
+        if (ready < 0 || (fds[1].revents & POLLIN))
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+        ssize_t n = read(w->fd, buf, sizeof(buf));
+        for (char *p = buf; n > 0 && p < buf + n;)
+        {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+            if (ev->wd < 0 || ev->wd >= w->dirCapacity || !w->dirs[ev->wd])
+                continue;
+            if (ev->mask & IN_IGNORED)
+            {
+                free(w->dirs[ev->wd]);
+                w->dirs[ev->wd] = NULL;
+                w->watchCount--;
+                continue;
+            }
+            if (ev->mask & IN_MOVE_SELF)
+                ImportWatchMoved(w, ev->wd);
+            if (ev->len == 0)
+                continue;
+            if (!ImportJoinPath(path, sizeof(path), w->dirs[ev->wd], ev->name))
+                continue;
+            if (ev->mask & IN_ISDIR)
+                ImportWatchTree(w, path, 0);
+            else if ((ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && ImportIsMp4(ev->name))
+                ImportWatchFile(w, path);
+        }
+    }
+    return NULL;
+}
+void ImportWatchStart(AppState *g)
+{
+    if (!g->watchMedia || g->importWatch)
+        return;
+    ImportWatch *w = calloc(1, sizeof(ImportWatch));
+    if (!w)
+        return;
+    w->g = g;
+    w->fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    w->wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (w->fd < 0 || w->wakeFd < 0 || pthread_create(&w->thread, NULL, ImportWatchFn, w) != 0)
+    {
+        fprintf(stderr, "Error: Failed to start media watcher\n");
+        if (w->fd >= 0)
+            close(w->fd);
+        if (w->wakeFd >= 0)
+            close(w->wakeFd);
+        free(w);
+        return;
+    }
+    g->importWatch = w;
+}
+void ImportWatchStop(AppState *g)
+{
+    ImportWatch *w = g->importWatch;
+    if (!w)
+        return;
+    uint64_t one = 1;
+    if (write(w->wakeFd, &one, sizeof(one)) != sizeof(one))
+        fprintf(stderr, "Error: Failed to wake media watcher\n");
+    pthread_join(w->thread, NULL);
+    close(w->fd);
+    close(w->wakeFd);
+    for (int i = 0; i < w->dirCapacity; i++)
+        free(w->dirs[i]);
+    free(w->dirs);
+    free(w);
+    g->importWatch = NULL;
+}
+void ImportAllMp4(AppState *g)
+{
+    if (g->importRunning) return;
+    g->importRunning     = true;
+    g->importDone        = false;
+    g->importAdded       = 0;
+    g->importSkipped     = 0;
+    g->importTotal       = 0;
+    g->importFinishedTime = 0.0;
+    g->importFinished    = false;
+    g->importCancel      = false;
+    g->importMergedVersion = g->importVersion;
+    g->importSeed = NameIndexKeys(&g->nameIndex, &g->importSeedCount);
+    if (pthread_create(&g->importThread, NULL, ImportThreadFn, g) != 0)
+    {
+        free(g->importSeed);
+        g->importSeed    = NULL;
+        g->importRunning = false;
+        g->importDone    = true;
+        fprintf(stderr, "ImportAllMp4: pthread_create failed\n");
+        return;
+    }
+}
+void ImportMerge(AppState *g)
+{
+    bool finished = atomic_load(&g->importFinished);
+    ImportBatch *list = atomic_exchange_explicit(&g->importInbox, NULL, memory_order_acquire);
+    ImportBatch *ordered = NULL;
+    while (list)
+    {
+        ImportBatch *next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+    while (ordered)
+    {
+        ImportBatch *b = ordered;
+        ordered = b->next;
+        for (int i = 0; i < b->count; i++)
+        {
+            const char *path = b->paths + b->offsets[i];
+            MediaLibrary *lib = libs[b->libs[i]];
+            int idx = NameIndexContains(&g->nameIndex, path) ? -1 : LibAdd(lib, path);
+            if (idx < 0)
+            {
+                atomic_fetch_add(&g->importSkipped, 1);
+                continue;
+            }
+            JournalAdd(g, lib, idx);
+            atomic_fetch_add(&g->importAdded, 1);
+        }
+        g->importMergedVersion = MAX(g->importMergedVersion, b->version);
+        ImportBatchFree(b);
+        FrameInvalidate(g, FRAME_IMPORT);
+    }
+    if (g->importRunning && finished &&
+        g->importMergedVersion == atomic_load(&g->importVersion))
+    {
+        pthread_join(g->importThread, NULL);
+        g->importRunning = false;
+        g->importDone    = true;
+        FrameInvalidate(g, FRAME_IMPORT);
+        if (g->importWatch)
+        {
+            ImportWatchStop(g);
+            ImportWatchStart(g);
+        }
+    }
+}
+void ImportShutdown(AppState *g)
+{
+    atomic_store(&g->importCancel, true);
+    ImportWatchStop(g);
+    if (g->importRunning)
+        pthread_join(g->importThread, NULL);
+    g->importRunning = false;
+    ImportBatch *list = atomic_exchange(&g->importInbox, NULL);
+    while (list)
+    {
+        ImportBatch *next = list->next;
+        ImportBatchFree(list);
+        list = next;
+    }
+}
@@ -0,0 +1,353 @@
+#include "include/journal.h"
+#include "include/persist.h"
+#include "include/settings.h"
+#include "include/store.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+_Static_assert(sizeof(JournalRecord) == 12, "JournalRecord must stay 12 bytes");
+#define JOURNAL_HEADER_SIZE 8
+static uint32_t crcTable[256];
+static uint32_t JournalCrc(const void *data, size_t len)
+{
+    if (!crcTable[1])
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crcTable[i] = c;
+        }
+    }
+    const unsigned char *p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++)
+        crc = crcTable[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+static bool JournalWriteAll(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+static MediaLibrary *JournalLib(AppState *g, int library)
+{
+    MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+    return (library >= 0 && library < 3) ? libs[library] : NULL;
+}
+static int JournalLibIndex(AppState *g, const MediaLibrary *lib)
+{
+    return lib == &g->movieLib ? 0 : lib == &g->videoLib ? 1 : 2;
+}
+static bool JournalApply(AppState *g, const JournalRecord *r, const char *path,
+                         const char *extra, size_t extraLen)
+{
+    MediaLibrary *lib = JournalLib(g, r->library);
+    if (!lib)
+        return false;
+    int idx = LibFind(lib, path);
+    switch (r->op)
+    {
+    case JOURNAL_ADD:
+        if (idx < 0)
+            LibAdd(lib, path);
+        return true;
+    case JOURNAL_REMOVE:
+        LibRemove(lib, idx);
+        return true;
+    case JOURNAL_MOVE:
+    {
+        MediaLibrary *dst = JournalLib(g, r->value);
+        if (!dst || dst == lib)
+            return false;
+        if (idx < 0)
+            return true;
+        if (LibFind(dst, path) >= 0)
+            LibRemove(lib, idx);
+        else
+            LibMove(lib, idx, dst);
+        return true;
+    }
+    case JOURNAL_FAVORITE:
+        if (idx >= 0)
+            LibSetFavorite(lib, idx, r->value != 0);
+        return true;
+    case JOURNAL_GENRE:
+        if (!extra)
+            return false;
+        if (idx >= 0)
+            LibSetGenre(lib, idx, GenreIntern(extra), r->value != 0);
+        return true;
+    case JOURNAL_PLACEHOLDER:
+        if (extraLen != PLACEHOLDER_BYTES + 1)
+            return false;
+        if (idx >= 0)
+            PlaceholderSet(&g->placeholders, lib->ids[idx], (const uint8_t *)extra);
+        return true;
+    default:
+        return false;
+    }
+}
+static size_t JournalReplay(AppState *g, const char *data, size_t size, int *applied)
+{
+    size_t pos = JOURNAL_HEADER_SIZE;
+    while (pos + sizeof(JournalRecord) <= size)
+    {
+        JournalRecord r;
+        memcpy(&r, data + pos, sizeof(r));
+        size_t end = pos + sizeof(r) + r.length;
+        if (r.length == 0 || end > size)
+            break;
+        if (JournalCrc(data + pos + 4, end - pos - 4) != r.crc)
+            break;
+        const char *path = data + pos + sizeof(r);
+        const char *last = data + end - 1;
+        if (*last != '\0')
+            break;
+        const char *extra = path + strlen(path) + 1;
+        if (!JournalApply(g, &r, path, extra <= last ? extra : NULL,
+                          extra <= last ? (size_t)(last - extra) + 1 : 0))
+            break;
+        (*applied)++;
+        pos = end;
+    }
+    return pos;
+}
+int JournalOpen(AppState *g)
+{
+    g->journalFd = -1;
+    int fd = open(JOURNAL_FILE, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: Failed to open %s\n", JOURNAL_FILE);
+        return 0;
+    }
+    struct stat st;
+    size_t size = (fstat(fd, &st) == 0) ? (size_t)st.st_size : 0;
+    char *data = size ? malloc(size) : NULL;
+    if (data && pread(fd, data, size, 0) != (ssize_t)size)
+    {
+        free(data);
+        data = NULL;
+    }
+    int applied = 0;
+    size_t valid = 0;
+    if (data && size >= JOURNAL_HEADER_SIZE && memcmp(data, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE) == 0)
+        valid = JournalReplay(g, data, size, &applied);
+    free(data);
+    if (valid == 0)
+    {
+        if (size > 0)
+            TraceLog(LOG_WARNING, "Discarding unreadable %s", JOURNAL_FILE);
+        if (ftruncate(fd, 0) != 0 || !JournalWriteAll(fd, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE))
+        {
+            fprintf(stderr, "Error: Failed to initialise %s\n", JOURNAL_FILE);
+            close(fd);
+            return 0;
+        }
+        valid = JOURNAL_HEADER_SIZE;
+    }
+    else if (valid < size)
+    {
+        TraceLog(LOG_WARNING, "Dropping %zu torn bytes from %s", size - valid, JOURNAL_FILE);
+        if (ftruncate(fd, (off_t)valid) != 0)
+            fprintf(stderr, "Error: Failed to truncate %s\n", JOURNAL_FILE);
+    }
+    if (applied > 0)
+        TraceLog(LOG_INFO, "Journal replayed: %d changes", applied);
+    g->journalFd = fd;
+    g->journalSize = valid;
+    g->journalCompactAt = JOURNAL_COMPACT_BYTES;
+    return applied;
+}
+static bool JournalRotate(AppState *g, size_t mark)
+{
+    size_t tail = g->journalSize - mark;
+    char *buf = malloc(JOURNAL_HEADER_SIZE + tail);
+    if (!buf)
+        return false;
+    memcpy(buf, JOURNAL_MAGIC, JOURNAL_HEADER_SIZE);
+    bool ok = pread(g->journalFd, buf + JOURNAL_HEADER_SIZE, tail, (off_t)mark) == (ssize_t)tail;
+    char tmpPath[PATH_MAX];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", JOURNAL_FILE);
+    int fd = ok ? open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (fd >= 0)
+    {
+        ok = JournalWriteAll(fd, buf, JOURNAL_HEADER_SIZE + tail) && fsync(fd) == 0;
+        ok = (close(fd) == 0) && ok;
+        ok = ok && rename(tmpPath, JOURNAL_FILE) == 0;
+        if (!ok)
+            unlink(tmpPath);
+    }
+    free(buf);
+    if (fd < 0 || !ok)
+        return false;
+    fd = open(JOURNAL_FILE, O_RDWR | O_APPEND);
+    if (fd < 0)
+        return false;
+    close(g->journalFd);
+    g->journalFd = fd;
+    g->journalSize = JOURNAL_HEADER_SIZE + tail;
+    return true;
+}
+void JournalCompact(AppState *g)
+{
+    if (g->journalFd < 0 || g->journalSize < g->journalCompactAt)
+        return;
+    pthread_mutex_lock(&g->libLock);
+    size_t size = 0;
+    char *image = StoreBuild(g, g->settingsJsonMtime, &size);
+    pthread_mutex_unlock(&g->libLock);
+    size_t mark = g->journalSize;
+    bool ok = image && StoreWrite(CATALOG_FILE, image, size) && JournalRotate(g, mark);
+    free(image);
+    if (!ok)
+        fprintf(stderr, "Error: Journal compaction failed\n");
+    g->journalCompactAt = g->journalSize + JOURNAL_COMPACT_BYTES;
+}
+bool JournalFlush(AppState *g)
+{
+    pthread_mutex_lock(&g->persistLock);
+    char *pending = g->journalPending;
+    size_t len = g->journalPendingLen;
+    g->journalPending = NULL;
+    g->journalPendingLen = 0;
+    g->journalPendingCap = 0;
+    pthread_mutex_unlock(&g->persistLock);
+    bool ok = true;
+    if (len > 0 && g->journalFd >= 0)
+    {
+        ok = JournalWriteAll(g->journalFd, pending, len);
+        if (ok)
+            g->journalSize += len;
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "Error: Failed to append to %s\n", JOURNAL_FILE);
+        if (ftruncate(g->journalFd, (off_t)g->journalSize) != 0)
+            fprintf(stderr, "Error: Failed to truncate %s\n", JOURNAL_FILE);
+        pthread_mutex_lock(&g->persistLock);
+        char *merged = realloc(pending, len + g->journalPendingLen);
+        if (merged)
+        {
+            if (g->journalPendingLen > 0)
+                memcpy(merged + len, g->journalPending, g->journalPendingLen);
+            free(g->journalPending);
+            g->journalPending = merged;
+            g->journalPendingLen += len;
+            g->journalPendingCap = g->journalPendingLen;
+            pending = NULL;
+        }
+        pthread_mutex_unlock(&g->persistLock);
+    }
+    free(pending);
+    return ok;
+}
+static void JournalWrite(AppState *g, JournalOp op, const MediaLibrary *lib, int value,
+                         const char *path, const char *extra, size_t extraLen)
+{
+    size_t pathLen = strlen(path) + 1;
+    size_t length = pathLen + extraLen;
+    if (length > UINT16_MAX)
+    {
+        fprintf(stderr, "Error: Journal record too long for %s\n", path);
+        return;
+    }
+    JournalRecord r = {0};
+    r.length = (uint16_t)length;
+    r.op = (uint8_t)op;
+    r.library = (uint8_t)JournalLibIndex(g, lib);
+    r.value = (uint8_t)value;
+    size_t total = sizeof(r) + length;
+    pthread_mutex_lock(&g->persistLock);
+    if (g->journalPendingLen + total > g->journalPendingCap)
+    {
+        size_t cap = g->journalPendingCap ? g->journalPendingCap : 4096;
+        while (cap < g->journalPendingLen + total)
+            cap *= 2;
+        char *grown = realloc(g->journalPending, cap);
+        if (!grown)
+        {
+            pthread_mutex_unlock(&g->persistLock);
+            fprintf(stderr, "Error: Out of memory queueing journal record\n");
+            return;
+        }
+        g->journalPending = grown;
+        g->journalPendingCap = cap;
+    }
+    char *buf = g->journalPending + g->journalPendingLen;
+    memcpy(buf, &r, sizeof(r));
+    memcpy(buf + sizeof(r), path, pathLen);
+    if (extra)
+        memcpy(buf + sizeof(r) + pathLen, extra, extraLen);
+    r.crc = JournalCrc(buf + 4, total - 4);
+    memcpy(buf, &r.crc, sizeof(r.crc));
+    g->journalPendingLen += total;
+    pthread_mutex_unlock(&g->persistLock);
+    PersistMarkDirty(g, PERSIST_JOURNAL);
+}
+void JournalAdd(AppState *g, MediaLibrary *lib, int index)
+{
+    JournalWrite(g, JOURNAL_ADD, lib, 0, LibPath(lib, index), NULL, 0);
+}
+void JournalRemove(AppState *g, MediaLibrary *lib, MediaId id)
+{
+    JournalWrite(g, JOURNAL_REMOVE, lib, 0, ArenaGet(lib->arena, id), NULL, 0);
+}
+void JournalMove(AppState *g, MediaLibrary *src, MediaLibrary *dst, int index)
+{
+    JournalWrite(g, JOURNAL_MOVE, src, JournalLibIndex(g, dst), LibPath(dst, index), NULL, 0);
+}
+void JournalFavorite(AppState *g, MediaLibrary *lib, int index)
+{
+    JournalWrite(g, JOURNAL_FAVORITE, lib, LibIsFavorite(lib, index), LibPath(lib, index), NULL, 0);
+}
+void JournalGenre(AppState *g, MediaLibrary *lib, int index, GenreId genre)
+{
+    const char *name = GenreName(genre);
+    JournalWrite(g, JOURNAL_GENRE, lib, LibHasGenre(lib, index, genre), LibPath(lib, index),
+                 name, strlen(name) + 1);
+}
+void JournalPlaceholder(AppState *g, MediaLibrary *lib, int index)
+{
+    const uint8_t *rgb = PlaceholderGet(&g->placeholders, lib->ids[index]);
+    if (!rgb)
+        return;
+    char extra[PLACEHOLDER_BYTES + 1];
+    memcpy(extra, rgb, PLACEHOLDER_BYTES);
+    extra[PLACEHOLDER_BYTES] = '\0';
+    JournalWrite(g, JOURNAL_PLACEHOLDER, lib, 0, LibPath(lib, index), extra, sizeof(extra));
+}
+void JournalReset(AppState *g)
+{
+    if (g->journalFd < 0)
+    {
+        unlink(JOURNAL_FILE);
+        return;
+    }
+    if (ftruncate(g->journalFd, JOURNAL_HEADER_SIZE) != 0)
+        fprintf(stderr, "Error: Failed to truncate %s\n", JOURNAL_FILE);
+    g->journalSize = JOURNAL_HEADER_SIZE;
+    g->journalCompactAt = JOURNAL_COMPACT_BYTES;
+}
+void JournalClose(AppState *g)
+{
+    free(g->journalPending);
+    g->journalPending = NULL;
+    g->journalPendingLen = 0;
+    g->journalPendingCap = 0;
+    if (g->journalFd >= 0)
+        close(g->journalFd);
+    g->journalFd = -1;
+}
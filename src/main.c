@@ -2,8 +2,13 @@
 #include "raylib.h"
 #include "include/gl_compat.h"
 #include "include/main.h"
+#include "include/frame.h"
 #include "include/utils.h"
 #include "include/settings.h"
+#include "include/import.h"
+#include "include/journal.h"
+#include "include/persist.h"
+#include "include/store.h"
 #include "include/thumbnails.h"
 #include "include/ui.h"
 #include "include/player.h"
@@ -26,8 +31,13 @@ int main(void)
     state.videoDuration = 0.0;
     state.videoTimePos = 0.0;
     state.seekProgress = 0.0f;
+    state.trickHoverSec = -1.0;
     state.selectedIndex = 0;
     state.gridScrollOffset = 0;
+    state.gridScrollTarget = 0;
+    state.gridScrollDir = 1;
+    for (int i = 0; i < 6; i++)
+        state.previewNext[i] = -1;
     state.showFavorites = false;
     state.showingOptions = false;
     state.optionsSelectedIndex = 0;
@@ -40,13 +50,29 @@ int main(void)
     state.logoVisibility = 1.0f;
     state.logoAnimatingOut = false;
     state.logoOffsetY = 0.0f;
+    state.thumbUploadMs = THUMB_UPLOAD_MS;
+    state.thumbUploadKB = THUMB_UPLOAD_KB;
+    state.thumbVramMB = THUMB_VRAM_MB;
+    state.thumbCacheMB = THUMB_CACHE_MB;
+    state.idleTimeoutSec = FRAME_IDLE_SEC;
+    state.idleFps = FRAME_IDLE_FPS;
+    state.frameLastInput = GetTime();
+    state.frameLastDraw = GetTime();
+    ArenaInit(&state.pathArena);
+    NameIndexInit(&state.nameIndex, &state.pathArena);
+    LibInit(&state.movieLib, &state.pathArena, &state.nameIndex);
+    LibInit(&state.videoLib, &state.pathArena, &state.nameIndex);
+    LibInit(&state.musicLib, &state.pathArena, &state.nameIndex);
+    pthread_mutex_init(&state.libLock, NULL);
+    pthread_mutex_init(&state.persistLock, NULL);
+    FrameStart(&state);
     LoadSettings(&state);
     LoadUserSettings(&state);
-    RefreshThumbnails(&state.movieLib);
-    RefreshThumbnails(&state.videoLib);
-    RefreshThumbnails(&state.musicLib);
+    PersistStart(&state);
+    ImportWatchStart(&state);
+    ThumbStart(&state);
     InitAudioDevice();
-    SetTargetFPS(60);
+    SetTargetFPS(FRAME_ACTIVE_FPS);
     state.logoModel = LoadModel("gui/logo.glb");
     state.logoScale = 10.0f;
     state.logoPos = (Vector3){-0.2f, 1.0f, 2.6f};
@@ -137,6 +163,7 @@ int main(void)
             {
                 printf("✓ MPV initialized successfully\n");
             }
+            PlayerAttach(&state);
         }
     }
     else
@@ -145,10 +172,16 @@ int main(void)
     }
     while (!WindowShouldClose() && !state.quit)
     {
+        FramePoll(&state);
         if (IsKeyPressed(KEY_F11))
             ToggleFullscreen();
+        pthread_mutex_lock(&state.libLock);
+        ImportMerge(&state);
+        ThumbUpload(&state);
+        PlayerPoll(&state);
         if (state.currentScreen == STATE_BOOT_SCREEN)
         {
+            FrameInvalidate(&state, FRAME_VIDEO);
             double currentTime = GetTime();
             double elapsed = currentTime - bootScreenStartTime;
             if (elapsed >= 5.0 || IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_SPACE))
@@ -207,20 +240,20 @@ int main(void)
                 state.selectedIndex = 0;
                 int pause = 1;
                 mpv_set_property(state.mpv, "pause", MPV_FORMAT_FLAG, &pause);
-                const char *seekCmd[] = {"seek", "0", "absolute", NULL};
-                mpv_command(state.mpv, seekCmd);
+                PlayerSeek(&state, 0.0, true);
             }
             break;
         default:
             break;
         }
-        if (state.mpv)
+        if (state.mpv && atomic_exchange(&state.playerEvents, false))
         {
             mpv_event *ev;
             while ((ev = mpv_wait_event(state.mpv, 0)))
             {
                 if (ev->event_id == MPV_EVENT_NONE)
                     break;
+                FrameInvalidate(&state, FRAME_VIDEO);
                 switch (ev->event_id)
                 {
                 case MPV_EVENT_END_FILE:
@@ -240,10 +273,17 @@ int main(void)
                 break;
                 case MPV_EVENT_FILE_LOADED:
                     TraceLog(LOG_INFO, "Video loaded: %s", GetFileName(state.currentVideoPath));
-                    mpv_get_property(state.mpv, "duration", MPV_FORMAT_DOUBLE, &state.videoDuration);
+                    break;
+                case MPV_EVENT_PROPERTY_CHANGE:
+                    PlayerProperty(&state, ev);
                     break;
                 case MPV_EVENT_PLAYBACK_RESTART:
                     TraceLog(LOG_INFO, "Playback restarted (seek completed)");
+                    PlayerSeekDone(&state);
+                    break;
+                case MPV_EVENT_COMMAND_REPLY:
+                    if (ev->reply_userdata == PLAYER_REPLY_SEEK && ev->error < 0)
+                        PlayerSeekDone(&state);
                     break;
                 case MPV_EVENT_SEEK:
                     TraceLog(LOG_INFO, "Seeking...");
@@ -280,6 +320,16 @@ int main(void)
             state.lastActivityTime = GetTime();
             state.logoAnimatingOut = false;
         }
+        if (!FrameBegin(&state))
+        {
+            pthread_mutex_unlock(&state.libLock);
+            FrameEnd(&state, false);
+            continue;
+        }
+        bool playing = state.currentScreen == STATE_PLAYING;
+        if (playing)
+            pthread_mutex_unlock(&state.libLock);
+        SetTargetFPS(playing ? 0 : FRAME_ACTIVE_FPS);
         BeginDrawing();
         ClearBackground(GetColor(0x121212FF));
         if (state.currentScreen == STATE_BOOT_SCREEN)
@@ -324,19 +374,27 @@ int main(void)
                 break;
             }
         }
+        FrameMeasure(&state);
+        if (!playing)
+            pthread_mutex_unlock(&state.libLock);
         EndDrawing();
+        PlayerSwapped(&state);
+        FrameEnd(&state, true);
     }
+    ImportShutdown(&state);
+    ThumbStop(&state);
+    PersistStop(&state);
+    JournalClose(&state);
     MediaLibrary *libs[] = {&state.movieLib, &state.videoLib, &state.musicLib};
     for (int j = 0; j < 3; j++)
     {
-        for (int i = 0; i < libs[j]->count; i++)
-        {
-            if (libs[j]->thumbnails[i].id > 0)
-            {
-                UnloadTexture(libs[j]->thumbnails[i]);
-            }
-        }
+        LibFree(libs[j]);
     }
+    ViewFree(&state.gridView);
+    NameIndexFree(&state.nameIndex);
+    ArenaFree(&state.pathArena);
+    PlaceholderFree(&state.placeholders);
+    StoreClose(&state);
     if (state.mpv_ctx)
         mpv_render_context_free(state.mpv_ctx);
     if (state.mpv)
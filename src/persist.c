@@ -0,0 +1,105 @@
+#include "include/persist.h"
+#include "include/journal.h"
+#include "include/settings.h"
+#include <errno.h>
+#include <time.h>
+static double PersistNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+static void PersistRun(AppState *g, unsigned flags)
+{
+    bool exported = (flags & PERSIST_EXPORT) && ExportSettingsJson(g);
+    if (flags & PERSIST_EXPORT)
+        atomic_store(&g->settingsExport, exported ? PERSIST_EXPORT_SAVED : PERSIST_EXPORT_FAILED);
+    if ((flags & PERSIST_JOURNAL) || exported)
+    {
+        JournalFlush(g);
+        if (exported)
+            g->journalCompactAt = 0;
+        JournalCompact(g);
+    }
+    if (flags & PERSIST_USER_SETTINGS)
+        SaveUserSettings(g);
+}
+static void *PersistThreadFn(void *arg)
+{
+    AppState *g = (AppState *)arg;
+    pthread_mutex_lock(&g->persistLock);
+    while (!g->persistStopping)
+    {
+        if (!g->persistDirty)
+        {
+            pthread_cond_wait(&g->persistCond, &g->persistLock);
+            continue;
+        }
+        double due = MIN(g->persistLastDirty + PERSIST_DEBOUNCE_SEC,
+                         g->persistFirstDirty + PERSIST_MAX_DELAY_SEC);
+        double now = PersistNow();
+        if (now < due)
+        {
+            struct timespec ts;
+            ts.tv_sec = (time_t)due;
+            ts.tv_nsec = (long)((due - (double)ts.tv_sec) * 1e9);
+            pthread_cond_timedwait(&g->persistCond, &g->persistLock, &ts);
+            continue;
+        }
+        unsigned flags = g->persistDirty;
+        g->persistDirty = 0;
+        pthread_mutex_unlock(&g->persistLock);
+        PersistRun(g, flags);
+        pthread_mutex_lock(&g->persistLock);
+    }
+    unsigned flags = g->persistDirty;
+    g->persistDirty = 0;
+    pthread_mutex_unlock(&g->persistLock);
+    PersistRun(g, flags);
+    return NULL;
+}
+void PersistStart(AppState *g)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g->persistCond, &attr);
+    pthread_condattr_destroy(&attr);
+    g->persistDirty = 0;
+    g->persistStopping = false;
+    g->persistRunning = pthread_create(&g->persistThread, NULL, PersistThreadFn, g) == 0;
+    if (!g->persistRunning)
+        fprintf(stderr, "Error: Failed to start persistence thread, saving on exit only\n");
+}
+void PersistMarkDirty(AppState *g, unsigned flags)
+{
+    double now = PersistNow();
+    pthread_mutex_lock(&g->persistLock);
+    if (!g->persistDirty)
+        g->persistFirstDirty = now;
+    g->persistLastDirty = now;
+    g->persistDirty |= flags;
+    pthread_cond_signal(&g->persistCond);
+    pthread_mutex_unlock(&g->persistLock);
+}
+void PersistRequestExport(AppState *g)
+{
+    atomic_store(&g->settingsExport, PERSIST_EXPORT_PENDING);
+    PersistMarkDirty(g, PERSIST_EXPORT);
+}
+void PersistStop(AppState *g)
+{
+    if (!g->persistRunning)
+    {
+        unsigned flags = g->persistDirty;
+        g->persistDirty = 0;
+        PersistRun(g, flags);
+        return;
+    }
+    pthread_mutex_lock(&g->persistLock);
+    g->persistStopping = true;
+    pthread_cond_signal(&g->persistCond);
+    pthread_mutex_unlock(&g->persistLock);
+    pthread_join(g->persistThread, NULL);
+    g->persistRunning = false;
+}
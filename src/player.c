@@ -1,5 +1,6 @@
-#include "include/main.h"
+#include "include/player.h"
 #include "include/gl_compat.h"
+#include "include/frame.h"
 #include <limits.h>
 void *get_rb_proc_address(void *ctx, const char *name)
 {
@@ -21,4 +22,159 @@ void PlayVideo(AppState *g, const char *path)
     g->currentScreen = STATE_PLAYING;
     g->isPaused = false;
     g->playbackPosition = 0.0f;
-}
\ No newline at end of file
+    g->videoTimePos = 0.0;
+    g->videoDuration = 0.0;
+    g->playerBuffering = false;
+    g->seekPending = false;
+    g->seekInFlight = false;
+    g->seekStreak = 0;
+}
+static void PlayerOnUpdate(void *ctx)
+{
+    AppState *g = (AppState *)ctx;
+    atomic_store(&g->playerUpdate, true);
+    FrameWake(g);
+}
+static void PlayerOnWakeup(void *ctx)
+{
+    AppState *g = (AppState *)ctx;
+    atomic_store(&g->playerEvents, true);
+    FrameWake(g);
+}
+static const struct
+{
+    PlayerProp  id;
+    const char *name;
+    mpv_format  format;
+} PLAYER_PROPS[] = {
+    {PLAYER_PROP_TIME_POS, "time-pos", MPV_FORMAT_DOUBLE},
+    {PLAYER_PROP_DURATION, "duration", MPV_FORMAT_DOUBLE},
+    {PLAYER_PROP_PAUSE, "pause", MPV_FORMAT_FLAG},
+    {PLAYER_PROP_BUFFERING, "paused-for-cache", MPV_FORMAT_FLAG},
+    {PLAYER_PROP_CACHE_PERCENT, "cache-buffering-state", MPV_FORMAT_INT64},
+    {PLAYER_PROP_CACHE_SEC, "demuxer-cache-duration", MPV_FORMAT_DOUBLE},
+    {PLAYER_PROP_TRACKS, "track-list/count", MPV_FORMAT_INT64},
+    {PLAYER_PROP_AID, "aid", MPV_FORMAT_INT64},
+    {PLAYER_PROP_SID, "sid", MPV_FORMAT_INT64},
+};
+void PlayerAttach(AppState *g)
+{
+    atomic_store(&g->playerEvents, true);
+    for (size_t i = 0; i < sizeof(PLAYER_PROPS) / sizeof(PLAYER_PROPS[0]); i++)
+        if (mpv_observe_property(g->mpv, PLAYER_PROPS[i].id, PLAYER_PROPS[i].name, PLAYER_PROPS[i].format) < 0)
+            TraceLog(LOG_WARNING, "Cannot observe mpv property %s", PLAYER_PROPS[i].name);
+    mpv_set_wakeup_callback(g->mpv, PlayerOnWakeup, g);
+    if (g->mpv_ctx)
+        mpv_render_context_set_update_callback(g->mpv_ctx, PlayerOnUpdate, g);
+}
+void PlayerPoll(AppState *g)
+{
+    if (!g->mpv_ctx || !atomic_exchange(&g->playerUpdate, false))
+        return;
+    if (mpv_render_context_update(g->mpv_ctx) & MPV_RENDER_UPDATE_FRAME)
+    {
+        g->playerFrameReady = true;
+        if (g->currentScreen == STATE_PLAYING)
+            FrameInvalidate(g, FRAME_VIDEO);
+    }
+}
+void PlayerSwapped(AppState *g)
+{
+    if (!g->playerRendered)
+        return;
+    mpv_render_context_report_swap(g->mpv_ctx);
+    g->playerRendered = false;
+}
+void PlayerProperty(AppState *g, const mpv_event *ev)
+{
+    const mpv_event_property *prop = (const mpv_event_property *)ev->data;
+    bool set = prop->format != MPV_FORMAT_NONE && prop->data;
+    double d = set && prop->format == MPV_FORMAT_DOUBLE ? *(double *)prop->data : 0.0;
+    int64_t n = set && prop->format == MPV_FORMAT_INT64 ? *(int64_t *)prop->data : 0;
+    bool flag = set && prop->format == MPV_FORMAT_FLAG && *(int *)prop->data;
+    switch (ev->reply_userdata)
+    {
+    case PLAYER_PROP_TIME_POS:
+        g->videoTimePos = d;
+        break;
+    case PLAYER_PROP_DURATION:
+        g->videoDuration = d;
+        break;
+    case PLAYER_PROP_PAUSE:
+        g->isPaused = flag;
+        break;
+    case PLAYER_PROP_BUFFERING:
+        g->playerBuffering = flag;
+        break;
+    case PLAYER_PROP_CACHE_PERCENT:
+        g->playerCachePercent = (int)n;
+        break;
+    case PLAYER_PROP_CACHE_SEC:
+        g->playerCacheSec = d;
+        break;
+    case PLAYER_PROP_TRACKS:
+        g->playerTrackCount = (int)n;
+        break;
+    case PLAYER_PROP_AID:
+        g->playerAudioId = (int)n;
+        break;
+    case PLAYER_PROP_SID:
+        g->playerSubId = (int)n;
+        break;
+    default:
+        break;
+    }
+}
+static const double PLAYER_SEEK_STEPS[] = {5.0, 10.0, 30.0, 60.0, 120.0};
+static void PlayerSeekFlush(AppState *g)
+{
+    if (!g->seekPending || (g->seekInFlight && GetTime() - g->seekIssuedAt < PLAYER_SEEK_TIMEOUT))
+        return;
+    char pos[32];
+    snprintf(pos, sizeof(pos), "%.3f", g->seekTarget);
+    const char *cmd[] = {"seek", pos, g->seekPendingExact ? "absolute+exact" : "absolute+keyframes", NULL};
+    g->seekPending = false;
+    if (mpv_command_async(g->mpv, PLAYER_REPLY_SEEK, cmd) < 0)
+        return;
+    g->seekInFlight = true;
+    g->seekIssuedAt = GetTime();
+}
+void PlayerSeek(AppState *g, double target, bool exact)
+{
+    if (!g->mpv)
+        return;
+    if (g->videoDuration > 0)
+        target = MIN(target, g->videoDuration);
+    target = MAX(target, 0.0);
+    if ((g->seekPending || g->seekInFlight) && target == g->seekTarget && exact == g->seekPendingExact)
+        return;
+    g->seekTarget = target;
+    g->seekPendingExact = exact;
+    g->seekPending = true;
+    FrameInvalidate(g, FRAME_VIDEO);
+    PlayerSeekFlush(g);
+}
+void PlayerSeekStep(AppState *g, int dir)
+{
+    double now = GetTime();
+    bool streak = dir == g->seekDir && now - g->seekLastStep < PLAYER_SEEK_STREAK;
+    double base = (streak || g->seekPending || g->seekInFlight) ? g->seekTarget : g->videoTimePos;
+    int steps = (int)(sizeof(PLAYER_SEEK_STEPS) / sizeof(PLAYER_SEEK_STEPS[0]));
+    g->seekStreak = streak ? g->seekStreak + 1 : 0;
+    g->seekDir = dir;
+    g->seekLastStep = now;
+    PlayerSeek(g, base + dir * PLAYER_SEEK_STEPS[MIN(g->seekStreak / PLAYER_SEEK_ACCEL, steps - 1)], false);
+}
+void PlayerSeekUpdate(AppState *g)
+{
+    PlayerSeekFlush(g);
+}
+void PlayerSeekDone(AppState *g)
+{
+    g->seekInFlight = false;
+    PlayerSeekFlush(g);
+}
+double PlayerPosition(const AppState *g)
+{
+    return (g->seekPending || g->seekInFlight || g->isSeeking) ? g->seekTarget : g->videoTimePos;
+}
@@ -0,0 +1,200 @@
+#include "include/qoi.h"
+#include <stdlib.h>
+#include <string.h>
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF  0x40
+#define QOI_OP_LUMA  0x80
+#define QOI_OP_RUN   0xc0
+#define QOI_OP_RGB   0xfe
+#define QOI_OP_RGBA  0xff
+#define QOI_MASK_2   0xc0
+typedef union
+{
+    struct
+    {
+        uint8_t r, g, b, a;
+    } rgba;
+    uint32_t v;
+} QoiPixel;
+static inline int QoiHash(QoiPixel p)
+{
+    return (p.rgba.r * 3 + p.rgba.g * 5 + p.rgba.b * 7 + p.rgba.a * 11) & 63;
+}
+static void QoiWrite32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+static uint32_t QoiRead32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+uint8_t *QoiEncode(const uint8_t *rgba, int width, int height, size_t *outLen)
+{
+    if (!rgba || width <= 0 || height <= 0 || (int64_t)width * height > QOI_MAX_PIXELS)
+        return NULL;
+    size_t pixels = (size_t)width * height;
+    uint8_t *out = malloc(QOI_HEADER_SIZE + pixels * 5 + QOI_PADDING);
+    if (!out)
+        return NULL;
+    memcpy(out, QOI_MAGIC, 4);
+    QoiWrite32(out + 4, (uint32_t)width);
+    QoiWrite32(out + 8, (uint32_t)height);
+    out[12] = 4;
+    out[13] = 0;
+    size_t pos = QOI_HEADER_SIZE;
+    QoiPixel index[64];
+    memset(index, 0, sizeof(index));
+    QoiPixel prev = {.rgba = {0, 0, 0, 255}};
+    int run = 0;
+    for (size_t i = 0; i < pixels; i++)
+    {
+        QoiPixel px;
+        memcpy(&px, rgba + i * 4, 4);
+        if (px.v == prev.v)
+        {
+            run++;
+            if (run == 62 || i == pixels - 1)
+            {
+                out[pos++] = QOI_OP_RUN | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0)
+        {
+            out[pos++] = QOI_OP_RUN | (run - 1);
+            run = 0;
+        }
+        int h = QoiHash(px);
+        if (index[h].v == px.v)
+        {
+            out[pos++] = QOI_OP_INDEX | h;
+        }
+        else
+        {
+            index[h] = px;
+            if (px.rgba.a == prev.rgba.a)
+            {
+                int8_t vr = (int8_t)(px.rgba.r - prev.rgba.r);
+                int8_t vg = (int8_t)(px.rgba.g - prev.rgba.g);
+                int8_t vb = (int8_t)(px.rgba.b - prev.rgba.b);
+                int8_t vgr = (int8_t)(vr - vg);
+                int8_t vgb = (int8_t)(vb - vg);
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                {
+                    out[pos++] = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                }
+                else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8)
+                {
+                    out[pos++] = QOI_OP_LUMA | (vg + 32);
+                    out[pos++] = (uint8_t)((vgr + 8) << 4 | (vgb + 8));
+                }
+                else
+                {
+                    out[pos++] = QOI_OP_RGB;
+                    out[pos++] = px.rgba.r;
+                    out[pos++] = px.rgba.g;
+                    out[pos++] = px.rgba.b;
+                }
+            }
+            else
+            {
+                out[pos++] = QOI_OP_RGBA;
+                memcpy(out + pos, &px, 4);
+                pos += 4;
+            }
+        }
+        prev = px;
+    }
+    memset(out + pos, 0, QOI_PADDING - 1);
+    out[pos + QOI_PADDING - 1] = 1;
+    *outLen = pos + QOI_PADDING;
+    return out;
+}
+uint8_t *QoiDecode(const uint8_t *data, size_t len, int *width, int *height)
+{
+    if (!data || len < QOI_HEADER_SIZE + QOI_PADDING || memcmp(data, QOI_MAGIC, 4) != 0)
+        return NULL;
+    uint32_t w = QoiRead32(data + 4);
+    uint32_t h = QoiRead32(data + 8);
+    if (w == 0 || h == 0 || (uint64_t)w * h > QOI_MAX_PIXELS)
+        return NULL;
+    size_t pixels = (size_t)w * h;
+    uint8_t *out = malloc(pixels * 4);
+    if (!out)
+        return NULL;
+    QoiPixel index[64];
+    memset(index, 0, sizeof(index));
+    QoiPixel px = {.rgba = {0, 0, 0, 255}};
+    size_t pos = QOI_HEADER_SIZE;
+    size_t end = len - QOI_PADDING;
+    int run = 0;
+    for (size_t i = 0; i < pixels; i++)
+    {
+        if (run > 0)
+        {
+            run--;
+        }
+        else if (pos < end)
+        {
+            int b1 = data[pos++];
+            if (b1 == QOI_OP_RGB)
+            {
+                if (pos + 3 > end)
+                    break;
+                px.rgba.r = data[pos];
+                px.rgba.g = data[pos + 1];
+                px.rgba.b = data[pos + 2];
+                pos += 3;
+            }
+            else if (b1 == QOI_OP_RGBA)
+            {
+                if (pos + 4 > end)
+                    break;
+                memcpy(&px, data + pos, 4);
+                pos += 4;
+            }
+            else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX)
+            {
+                px = index[b1];
+            }
+            else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF)
+            {
+                px.rgba.r += ((b1 >> 4) & 0x03) - 2;
+                px.rgba.g += ((b1 >> 2) & 0x03) - 2;
+                px.rgba.b += (b1 & 0x03) - 2;
+            }
+            else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA)
+            {
+                if (pos + 1 > end)
+                    break;
+                int b2 = data[pos++];
+                int vg = (b1 & 0x3f) - 32;
+                px.rgba.r += vg - 8 + ((b2 >> 4) & 0x0f);
+                px.rgba.g += vg;
+                px.rgba.b += vg - 8 + (b2 & 0x0f);
+            }
+            else
+            {
+                run = b1 & 0x3f;
+            }
+            index[QoiHash(px)] = px;
+        }
+        else
+        {
+            break;
+        }
+        memcpy(out + i * 4, &px, 4);
+        if (i == pixels - 1)
+        {
+            *width = (int)w;
+            *height = (int)h;
+            return out;
+        }
+    }
+    free(out);
+    return NULL;
+}
@@ -0,0 +1,132 @@
+#include "include/query.h"
+#include <stdlib.h>
+#include <string.h>
+static inline uint64_t QueryBits(const uint64_t *bits, int w)
+{
+    return bits ? bits[w] : 0;
+}
+static uint64_t QueryWord(const MediaLibrary *lib, const MediaFilter *f, int w)
+{
+    if (f->matchNone)
+        return 0;
+    uint64_t acc = ~0ull;
+    for (uint64_t m = f->allOf; m; m &= m - 1)
+        acc &= QueryBits(lib->genreBits[__builtin_ctzll(m)], w);
+    if (f->anyOf)
+    {
+        uint64_t any = 0;
+        for (uint64_t m = f->anyOf; m; m &= m - 1)
+            any |= QueryBits(lib->genreBits[__builtin_ctzll(m)], w);
+        acc &= any;
+    }
+    for (uint64_t m = f->noneOf; m; m &= m - 1)
+        acc &= ~QueryBits(lib->genreBits[__builtin_ctzll(m)], w);
+    if (f->favoritesOnly)
+        acc &= QueryBits(lib->favBits, w);
+    int valid = lib->count - w * 64;
+    if (valid < 64)
+        acc &= (1ull << valid) - 1;
+    return acc;
+}
+void FilterRequireGenre(MediaFilter *f, const char *name)
+{
+    GenreId id = GenreFind(name);
+    if (id == GENRE_NONE)
+        f->matchNone = true;
+    else
+        f->allOf |= 1ull << id;
+}
+int QueryNext(const MediaLibrary *lib, const MediaFilter *f, int from)
+{
+    if (from < 0)
+        from = 0;
+    int words = (lib->count + 63) / 64;
+    for (int w = from >> 6; w < words; w++)
+    {
+        uint64_t bits = QueryWord(lib, f, w);
+        if (w == from >> 6)
+            bits &= ~0ull << (from & 63);
+        if (bits)
+            return w * 64 + __builtin_ctzll(bits);
+    }
+    return -1;
+}
+int QueryNth(const MediaLibrary *lib, const MediaFilter *f, int n)
+{
+    if (n < 0)
+        return -1;
+    int words = (lib->count + 63) / 64;
+    for (int w = 0; w < words; w++)
+    {
+        uint64_t bits = QueryWord(lib, f, w);
+        int pop = __builtin_popcountll(bits);
+        if (n >= pop)
+        {
+            n -= pop;
+            continue;
+        }
+        while (n-- > 0)
+            bits &= bits - 1;
+        return w * 64 + __builtin_ctzll(bits);
+    }
+    return -1;
+}
+int QueryCount(const MediaLibrary *lib, const MediaFilter *f)
+{
+    int words = (lib->count + 63) / 64;
+    int count = 0;
+    for (int w = 0; w < words; w++)
+        count += __builtin_popcountll(QueryWord(lib, f, w));
+    return count;
+}
+int QueryGenreCount(const MediaLibrary *lib, GenreId genre)
+{
+    if (genre < 0 || genre >= MAX_GENRES || !lib->genreBits[genre])
+        return 0;
+    int words = (lib->count + 63) / 64;
+    int count = 0;
+    for (int w = 0; w < words; w++)
+        count += __builtin_popcountll(lib->genreBits[genre][w]);
+    return count;
+}
+static bool FilterEqual(const MediaFilter *a, const MediaFilter *b)
+{
+    return a->allOf == b->allOf && a->anyOf == b->anyOf && a->noneOf == b->noneOf &&
+           a->favoritesOnly == b->favoritesOnly && a->matchNone == b->matchNone;
+}
+void ViewRefresh(MediaView *v, const MediaLibrary *lib, const MediaFilter *f)
+{
+    if (v->lib == lib && v->generation == lib->generation && FilterEqual(&v->filter, f))
+        return;
+    if (v->capacity < lib->count)
+    {
+        int capacity = v->capacity ? v->capacity : 256;
+        while (capacity < lib->count)
+            capacity *= 2;
+        int *items = realloc(v->items, capacity * sizeof(int));
+        if (!items)
+        {
+            v->lib = NULL;
+            v->count = 0;
+            return;
+        }
+        v->items = items;
+        v->capacity = capacity;
+    }
+    int words = (lib->count + 63) / 64;
+    int count = 0;
+    for (int w = 0; w < words; w++)
+    {
+        for (uint64_t bits = QueryWord(lib, f, w); bits; bits &= bits - 1)
+            v->items[count++] = w * 64 + __builtin_ctzll(bits);
+    }
+    v->lib = lib;
+    v->filter = *f;
+    v->generation = lib->generation;
+    v->count = count;
+}
+void ViewFree(MediaView *v)
+{
+    free(v->items);
+    memset(v, 0, sizeof(*v));
+}
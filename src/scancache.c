@@ -0,0 +1,146 @@
+#include "include/scancache.h"
+#include "include/store.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+_Static_assert(sizeof(ScanCacheHeader) == 32, "ScanCacheHeader must stay 32 bytes");
+_Static_assert(sizeof(ScanCacheRecord) == 48, "ScanCacheRecord must stay 48 bytes");
+void ScanCacheInit(ScanCache *c)
+{
+    memset(c, 0, sizeof(*c));
+    ArenaInit(&c->paths);
+}
+void ScanCacheFree(ScanCache *c)
+{
+    ArenaFree(&c->paths);
+    free(c->entries);
+    memset(c, 0, sizeof(*c));
+}
+int32_t ScanCacheFind(const ScanCache *c, const char *path)
+{
+    MediaId id = ArenaFind(&c->paths, path);
+    return (id == MEDIA_ID_NONE || id >= c->count) ? SCAN_NONE : (int32_t)id;
+}
+int32_t ScanCacheAdd(ScanCache *c, const char *path, int32_t parent, const ScanEntry *fp)
+{
+    MediaId id = ArenaIntern(&c->paths, path);
+    if (id == MEDIA_ID_NONE || id > c->count)
+        return SCAN_NONE;
+    if (id < c->count)
+    {
+        ScanEntry *e = &c->entries[id];
+        int32_t firstChild = e->firstChild, nextSibling = e->nextSibling, oldParent = e->parent;
+        *e = *fp;
+        e->parent = oldParent;
+        e->firstChild = firstChild;
+        e->nextSibling = nextSibling;
+        return (int32_t)id;
+    }
+    if (c->count == c->capacity)
+    {
+        uint32_t capacity = c->capacity ? c->capacity * 2 : 1024;
+        ScanEntry *entries = realloc(c->entries, capacity * sizeof(ScanEntry));
+        if (!entries)
+            return SCAN_NONE;
+        c->entries = entries;
+        c->capacity = capacity;
+    }
+    ScanEntry *e = &c->entries[c->count++];
+    *e = *fp;
+    e->parent = (parent >= 0 && parent < (int32_t)id) ? parent : SCAN_NONE;
+    e->firstChild = SCAN_NONE;
+    e->nextSibling = SCAN_NONE;
+    if (e->parent != SCAN_NONE)
+    {
+        e->nextSibling = c->entries[e->parent].firstChild;
+        c->entries[e->parent].firstChild = (int32_t)id;
+    }
+    return (int32_t)id;
+}
+bool ScanCacheLoad(ScanCache *c, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    char *data = NULL;
+    size_t size = 0;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(ScanCacheHeader))
+    {
+        size = (size_t)st.st_size;
+        data = malloc(size);
+        if (data && pread(fd, data, size, 0) != (ssize_t)size)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+    close(fd);
+    if (!data)
+        return false;
+    const ScanCacheHeader *h = (const ScanCacheHeader *)data;
+    const char *why = NULL;
+    uint64_t stringsOff = sizeof(ScanCacheHeader) + (uint64_t)h->count * sizeof(ScanCacheRecord);
+    if (memcmp(h->magic, SCAN_CACHE_MAGIC, sizeof(h->magic)) != 0 || h->version != SCAN_CACHE_VERSION)
+        why = "unsupported format";
+    else if (stringsOff + h->stringBytes != size || (h->stringBytes && data[size - 1] != '\0'))
+        why = "truncated";
+    else if (StoreChecksum(data + sizeof(ScanCacheHeader), size - sizeof(ScanCacheHeader)) != h->checksum)
+        why = "checksum mismatch";
+    const ScanCacheRecord *records = (const ScanCacheRecord *)(data + sizeof(ScanCacheHeader));
+    const char *strings = data + stringsOff;
+    for (uint32_t i = 0; !why && i < h->count; i++)
+    {
+        const ScanCacheRecord *r = &records[i];
+        if (r->path >= h->stringBytes || r->parent >= (int32_t)i)
+        {
+            why = "bad record";
+            break;
+        }
+        ScanEntry e = {r->ino, r->mtimeNs, r->size, r->duration, 0, 0, 0, r->isDir != 0};
+        if (ScanCacheAdd(c, strings + r->path, r->parent, &e) != (int32_t)i)
+            why = "duplicate path";
+    }
+    free(data);
+    if (why)
+    {
+        TraceLog(LOG_WARNING, "Ignoring %s: %s", path, why);
+        ScanCacheFree(c);
+        ScanCacheInit(c);
+        return false;
+    }
+    return true;
+}
+bool ScanCacheSave(const ScanCache *c, const char *path)
+{
+    uint64_t stringBytes = 0;
+    for (uint32_t i = 0; i < c->count; i++)
+        stringBytes += strlen(ScanCachePath(c, (int32_t)i)) + 1;
+    size_t stringsOff = sizeof(ScanCacheHeader) + (size_t)c->count * sizeof(ScanCacheRecord);
+    size_t size = stringsOff + stringBytes;
+    if (stringBytes > UINT32_MAX)
+        return false;
+    char *buf = calloc(1, size);
+    if (!buf)
+        return false;
+    ScanCacheHeader *h = (ScanCacheHeader *)buf;
+    memcpy(h->magic, SCAN_CACHE_MAGIC, sizeof(h->magic));
+    h->version = SCAN_CACHE_VERSION;
+    h->count = c->count;
+    h->stringBytes = stringBytes;
+    ScanCacheRecord *records = (ScanCacheRecord *)(buf + sizeof(ScanCacheHeader));
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < c->count; i++)
+    {
+        const ScanEntry *e = &c->entries[i];
+        const char *str = ScanCachePath(c, (int32_t)i);
+        size_t n = strlen(str) + 1;
+        memcpy(buf + stringsOff + pos, str, n);
+        records[i] = (ScanCacheRecord){e->ino, e->mtimeNs, e->size, e->duration, e->parent, pos, e->isDir, {0}};
+        pos += (uint32_t)n;
+    }
+    h->checksum = StoreChecksum(buf + sizeof(ScanCacheHeader), size - sizeof(ScanCacheHeader));
+    bool ok = StoreWrite(path, buf, size);
+    free(buf);
+    return ok;
+}
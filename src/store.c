@@ -0,0 +1,280 @@
+#include "include/store.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+_Static_assert(sizeof(CatalogHeader) == 64, "CatalogHeader must stay 64 bytes");
+_Static_assert(sizeof(CatalogRecord) == 16, "CatalogRecord must stay 16 bytes");
+static size_t StoreAlign8(size_t n)
+{
+    return (n + 7) & ~(size_t)7;
+}
+uint64_t StoreChecksum(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ len;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h ^= w * 0xff51afd7ed558ccdull;
+        h = ((h << 31) | (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    }
+    for (; i < len; i++)
+    {
+        h ^= p[i] * 0xff51afd7ed558ccdull;
+        h = ((h << 31) | (h >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    }
+    return h ^ (h >> 29);
+}
+bool StoreLoad(AppState *g, const char *path, long jsonMtime)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CatalogHeader))
+    {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    const CatalogHeader *h = map;
+    const char *why = NULL;
+    if (memcmp(h->magic, CATALOG_MAGIC, sizeof(h->magic)) != 0)
+        why = "bad magic";
+    else if (h->version < 1 || h->version > CATALOG_VERSION || h->headerSize != sizeof(CatalogHeader))
+        why = "unsupported version";
+    else if (jsonMtime != 0 && h->jsonMtime != jsonMtime)
+        why = "settings.json was edited";
+    if (!why)
+    {
+        uint64_t genresOff  = sizeof(CatalogHeader);
+        uint64_t offsetsOff = genresOff + (uint64_t)h->genreCount * 4;
+        uint64_t recordsOff = StoreAlign8(offsetsOff + (uint64_t)h->stringCount * 4);
+        uint64_t placeholdersOff = recordsOff + (uint64_t)h->recordCount * sizeof(CatalogRecord);
+        uint64_t stringsOff = placeholdersOff + (uint64_t)h->placeholderCount * PLACEHOLDER_BYTES;
+        if (h->genreCount > MAX_GENRES || stringsOff + h->stringBytes != size ||
+            h->stringBytes == 0 || h->placeholderCount > h->recordCount)
+            why = "truncated";
+        else if (StoreChecksum((const char *)map + genresOff, size - genresOff) != h->checksum)
+            why = "checksum mismatch";
+        else
+        {
+            const uint32_t *genreNames = (const uint32_t *)((const char *)map + genresOff);
+            const uint32_t *offsets = (const uint32_t *)((const char *)map + offsetsOff);
+            const CatalogRecord *records = (const CatalogRecord *)((const char *)map + recordsOff);
+            const uint8_t *placeholders = (const uint8_t *)map + placeholdersOff;
+            const char *strings = (const char *)map + stringsOff;
+            if (strings[h->stringBytes - 1] != '\0')
+                why = "unterminated string table";
+            for (uint32_t i = 0; !why && i < h->stringCount; i++)
+                if (offsets[i] >= h->stringBytes)
+                    why = "bad string offset";
+            for (uint32_t i = 0; !why && i < h->genreCount; i++)
+                if (genreNames[i] >= h->stringCount)
+                    why = "bad genre name";
+            uint32_t placeholderCount = 0;
+            for (uint32_t i = 0; !why && i < h->recordCount; i++)
+            {
+                if (records[i].path < h->genreCount || records[i].path >= h->stringCount ||
+                    records[i].library > 2)
+                    why = "bad record";
+                if (records[i].flags & CATALOG_RECORD_PLACEHOLDER)
+                    placeholderCount++;
+            }
+            if (!why && placeholderCount != h->placeholderCount)
+                why = "bad placeholder count";
+            if (!why && !ArenaAdopt(&g->pathArena, strings, h->stringBytes, offsets, h->stringCount))
+                why = "path arena already in use";
+            if (!why)
+            {
+                GenreId genreMap[MAX_GENRES];
+                for (uint32_t i = 0; i < h->genreCount; i++)
+                    genreMap[i] = GenreIntern(strings + offsets[genreNames[i]]);
+                MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+                for (uint32_t i = 0; i < h->recordCount; i++)
+                {
+                    const CatalogRecord *r = &records[i];
+                    MediaLibrary *lib = libs[r->library];
+                    int idx = LibAddId(lib, r->path);
+                    if (idx < 0)
+                        break;
+                    if (r->flags & CATALOG_RECORD_FAVORITE)
+                        LibSetFavorite(lib, idx, true);
+                    if (r->flags & CATALOG_RECORD_PLACEHOLDER)
+                    {
+                        PlaceholderSet(&g->placeholders, r->path, placeholders);
+                        placeholders += PLACEHOLDER_BYTES;
+                    }
+                    for (uint64_t m = r->genres; m; m &= m - 1)
+                    {
+                        int bit = __builtin_ctzll(m);
+                        if ((uint32_t)bit < h->genreCount)
+                            LibSetGenre(lib, idx, genreMap[bit], true);
+                    }
+                }
+                g->storeMap = map;
+                g->storeMapLen = size;
+                TraceLog(LOG_INFO, "Catalog loaded: %u items from %s", h->recordCount, path);
+                return true;
+            }
+        }
+    }
+    TraceLog(LOG_WARNING, "Ignoring %s: %s", path, why);
+    munmap(map, size);
+    return false;
+}
+char *StoreBuild(AppState *g, long jsonMtime, size_t *sizeOut)
+{
+    MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+    StringArena *arena = &g->pathArena;
+    uint32_t genreCount = (uint32_t)GenreCount();
+    uint32_t *remap = malloc((arena->count + 1) * sizeof(uint32_t));
+    if (!remap)
+        return NULL;
+    memset(remap, 0xff, (arena->count + 1) * sizeof(uint32_t));
+    uint32_t stringCount = genreCount;
+    uint64_t stringBytes = 0;
+    uint32_t recordCount = 0;
+    uint32_t placeholderCount = 0;
+    for (uint32_t i = 0; i < genreCount; i++)
+        stringBytes += strlen(GenreName(i)) + 1;
+    for (int j = 0; j < 3; j++)
+    {
+        for (int i = 0; i < libs[j]->count; i++)
+        {
+            MediaId id = libs[j]->ids[i];
+            if (remap[id] == UINT32_MAX)
+            {
+                remap[id] = stringCount++;
+                stringBytes += strlen(ArenaGet(arena, id)) + 1;
+            }
+            if (PlaceholderGet(&g->placeholders, id))
+                placeholderCount++;
+            recordCount++;
+        }
+    }
+    if (stringBytes == 0)
+        stringBytes = 1;
+    size_t offsetsOff = sizeof(CatalogHeader) + (size_t)genreCount * 4;
+    size_t recordsOff = StoreAlign8(offsetsOff + (size_t)stringCount * 4);
+    size_t placeholdersOff = recordsOff + (size_t)recordCount * sizeof(CatalogRecord);
+    size_t stringsOff = placeholdersOff + (size_t)placeholderCount * PLACEHOLDER_BYTES;
+    size_t size = stringsOff + stringBytes;
+    if (size > UINT32_MAX)
+    {
+        free(remap);
+        fprintf(stderr, "Error: Catalog too large to save\n");
+        return NULL;
+    }
+    char *buf = calloc(1, size);
+    if (!buf)
+    {
+        free(remap);
+        return NULL;
+    }
+    CatalogHeader *h = (CatalogHeader *)buf;
+    memcpy(h->magic, CATALOG_MAGIC, sizeof(h->magic));
+    h->version = CATALOG_VERSION;
+    h->headerSize = sizeof(CatalogHeader);
+    h->jsonMtime = jsonMtime;
+    h->genreCount = genreCount;
+    h->stringCount = stringCount;
+    h->stringBytes = (uint32_t)stringBytes;
+    h->recordCount = recordCount;
+    h->placeholderCount = placeholderCount;
+    uint32_t *genreNames = (uint32_t *)(buf + sizeof(CatalogHeader));
+    uint32_t *offsets = (uint32_t *)(buf + offsetsOff);
+    CatalogRecord *records = (CatalogRecord *)(buf + recordsOff);
+    uint8_t *placeholders = (uint8_t *)buf + placeholdersOff;
+    char *strings = buf + stringsOff;
+    uint32_t pos = 0;
+    for (uint32_t i = 0; i < genreCount; i++)
+    {
+        const char *name = GenreName(i);
+        size_t n = strlen(name) + 1;
+        genreNames[i] = i;
+        offsets[i] = pos;
+        memcpy(strings + pos, name, n);
+        pos += (uint32_t)n;
+    }
+    uint32_t r = 0;
+    uint32_t nextString = genreCount;
+    for (int j = 0; j < 3; j++)
+    {
+        MediaLibrary *lib = libs[j];
+        for (int i = 0; i < lib->count; i++)
+        {
+            uint32_t s = remap[lib->ids[i]];
+            if (s == nextString)
+            {
+                const char *str = ArenaGet(arena, lib->ids[i]);
+                size_t n = strlen(str) + 1;
+                offsets[s] = pos;
+                memcpy(strings + pos, str, n);
+                pos += (uint32_t)n;
+                nextString++;
+            }
+            CatalogRecord *rec = &records[r++];
+            rec->path = s;
+            rec->library = (uint8_t)j;
+            rec->flags = LibIsFavorite(lib, i) ? CATALOG_RECORD_FAVORITE : 0;
+            const uint8_t *rgb = PlaceholderGet(&g->placeholders, lib->ids[i]);
+            if (rgb)
+            {
+                rec->flags |= CATALOG_RECORD_PLACEHOLDER;
+                memcpy(placeholders, rgb, PLACEHOLDER_BYTES);
+                placeholders += PLACEHOLDER_BYTES;
+            }
+            for (int k = 0; k < (int)genreCount; k++)
+                if (LibHasGenre(lib, i, k))
+                    rec->genres |= 1ull << k;
+        }
+    }
+    free(remap);
+    h->checksum = StoreChecksum(buf + sizeof(CatalogHeader), size - sizeof(CatalogHeader));
+    *sizeOut = size;
+    return buf;
+}
+bool StoreWrite(const char *path, const char *image, size_t size)
+{
+    bool ok = false;
+    char tmpPath[PATH_MAX];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *f = fopen(tmpPath, "wb");
+    if (f)
+    {
+        ok = fwrite(image, 1, size, f) == size && fflush(f) == 0 && fsync(fileno(f)) == 0;
+        ok = (fclose(f) == 0) && ok;
+        if (ok)
+            ok = rename(tmpPath, path) == 0;
+        if (!ok)
+            unlink(tmpPath);
+    }
+    if (!ok)
+        fprintf(stderr, "Error: Failed to write %s\n", path);
+    return ok;
+}
+bool StoreSave(AppState *g, const char *path, long jsonMtime)
+{
+    size_t size = 0;
+    char *image = StoreBuild(g, jsonMtime, &size);
+    if (!image)
+        return false;
+    bool ok = StoreWrite(path, image, size);
+    free(image);
+    return ok;
+}
+void StoreClose(AppState *g)
+{
+    if (g->storeMap)
+        munmap(g->storeMap, g->storeMapLen);
+    g->storeMap = NULL;
+    g->storeMapLen = 0;
+}
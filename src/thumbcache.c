@@ -0,0 +1,447 @@
+#include "include/thumbcache.h"
+#include "include/qoi.h"
+#include "include/store.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+_Static_assert(sizeof(ThumbCacheHeader) == 24, "ThumbCacheHeader must stay 24 bytes");
+_Static_assert(sizeof(ThumbCacheRecord) == 32, "ThumbCacheRecord must stay 32 bytes");
+static bool ThumbCacheMkdirs(char *path)
+{
+    for (char *p = path + 1; *p; p++)
+    {
+        if (*p != '/')
+            continue;
+        *p = '\0';
+        bool ok = mkdir(path, 0755) == 0 || errno == EEXIST;
+        *p = '/';
+        if (!ok)
+            return false;
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+static bool ThumbCacheDir(char *out, size_t outLen)
+{
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int len;
+    if (xdg && xdg[0] == '/')
+        len = snprintf(out, outLen, "%s/%s", xdg, THUMB_CACHE_DIR);
+    else if (home && home[0])
+        len = snprintf(out, outLen, "%s/.cache/%s", home, THUMB_CACHE_DIR);
+    else
+        return false;
+    return len > 0 && (size_t)len < outLen && ThumbCacheMkdirs(out);
+}
+static uint32_t ThumbCacheSlot(uint64_t key)
+{
+    return (uint32_t)(key ^ (key >> 32));
+}
+static bool ThumbCacheRehash(ThumbCache *c, uint32_t slotCount)
+{
+    uint32_t *slots = malloc(slotCount * sizeof(uint32_t));
+    if (!slots)
+        return false;
+    memset(slots, 0xff, slotCount * sizeof(uint32_t));
+    uint32_t mask = slotCount - 1;
+    for (uint32_t i = 0; i < c->count; i++)
+    {
+        uint32_t s = ThumbCacheSlot(c->entries[i].key) & mask;
+        while (slots[s] != UINT32_MAX)
+            s = (s + 1) & mask;
+        slots[s] = i;
+    }
+    free(c->slots);
+    c->slots = slots;
+    c->slotMask = mask;
+    return true;
+}
+static ThumbCacheRecord *ThumbCacheFind(const ThumbCache *c, uint64_t key)
+{
+    if (!c->slots)
+        return NULL;
+    for (uint32_t s = ThumbCacheSlot(key) & c->slotMask; c->slots[s] != UINT32_MAX; s = (s + 1) & c->slotMask)
+        if (c->entries[c->slots[s]].key == key)
+            return &c->entries[c->slots[s]];
+    return NULL;
+}
+static bool ThumbCacheInsert(ThumbCache *c, const ThumbCacheRecord *r)
+{
+    ThumbCacheRecord *existing = ThumbCacheFind(c, r->key);
+    if (existing)
+    {
+        *existing = *r;
+        return true;
+    }
+    if (c->count == c->capacity)
+    {
+        uint32_t capacity = c->capacity ? c->capacity * 2 : 1024;
+        ThumbCacheRecord *entries = realloc(c->entries, capacity * sizeof(ThumbCacheRecord));
+        if (!entries)
+            return false;
+        c->entries = entries;
+        c->capacity = capacity;
+    }
+    if (!c->slots || (c->count + 1) * 2 > c->slotMask + 1)
+    {
+        uint32_t slotCount = c->slots ? (c->slotMask + 1) * 2 : 2048;
+        if (!ThumbCacheRehash(c, slotCount))
+            return false;
+    }
+    c->entries[c->count] = *r;
+    uint32_t s = ThumbCacheSlot(r->key) & c->slotMask;
+    while (c->slots[s] != UINT32_MAX)
+        s = (s + 1) & c->slotMask;
+    c->slots[s] = c->count++;
+    return true;
+}
+static void ThumbCacheReset(ThumbCache *c)
+{
+    free(c->entries);
+    free(c->slots);
+    c->entries = NULL;
+    c->slots = NULL;
+    c->count = c->capacity = c->slotMask = 0;
+}
+static bool ThumbCacheLoadIndex(ThumbCache *c)
+{
+    int fd = open(c->indexPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st, pack;
+    ThumbCacheHeader h;
+    bool valid = fstat(fd, &st) == 0 && pread(fd, &h, sizeof(h), 0) == sizeof(h) &&
+                 memcmp(h.magic, THUMB_CACHE_MAGIC, sizeof(h.magic)) == 0 &&
+                 h.version == THUMB_CACHE_VERSION && h.recordSize == sizeof(ThumbCacheRecord);
+    if (!valid)
+    {
+        TraceLog(LOG_WARNING, "Ignoring %s: unsupported format", c->indexPath);
+        close(fd);
+        return false;
+    }
+    if (fstat(c->packFd, &pack) != 0 || h.packId != (uint64_t)pack.st_ino)
+    {
+        TraceLog(LOG_WARNING, "Ignoring %s: written for a different %s", c->indexPath, THUMB_CACHE_PACK);
+        close(fd);
+        return false;
+    }
+    size_t count = ((size_t)st.st_size - sizeof(h)) / sizeof(ThumbCacheRecord);
+    ThumbCacheRecord *records = malloc(count * sizeof(ThumbCacheRecord) + 1);
+    ssize_t want = (ssize_t)(count * sizeof(ThumbCacheRecord));
+    if (records && pread(fd, records, want, sizeof(h)) == want)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const ThumbCacheRecord *r = &records[i];
+            bool failed = r->size == 0 && r->width == 0 && r->height == 0;
+            bool image = r->size >= QOI_HEADER_SIZE + QOI_PADDING && r->width > 0 && r->height > 0;
+            if (r->key != 0 && r->offset + r->size <= c->packSize && (failed || image))
+                ThumbCacheInsert(c, r);
+        }
+    }
+    free(records);
+    close(fd);
+    return true;
+}
+static bool ThumbCacheWriteIndex(ThumbCache *c)
+{
+    size_t size = sizeof(ThumbCacheHeader) + (size_t)c->count * sizeof(ThumbCacheRecord);
+    char *buf = malloc(size);
+    if (!buf)
+        return false;
+    ThumbCacheHeader *h = (ThumbCacheHeader *)buf;
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, THUMB_CACHE_MAGIC, sizeof(h->magic));
+    h->version = THUMB_CACHE_VERSION;
+    h->recordSize = sizeof(ThumbCacheRecord);
+    struct stat pack;
+    if (fstat(c->packFd, &pack) == 0)
+        h->packId = (uint64_t)pack.st_ino;
+    if (c->count)
+        memcpy(buf + sizeof(ThumbCacheHeader), c->entries, (size_t)c->count * sizeof(ThumbCacheRecord));
+    bool ok = StoreWrite(c->indexPath, buf, size);
+    free(buf);
+    if (c->indexFd >= 0)
+        close(c->indexFd);
+    c->indexFd = open(c->indexPath, O_WRONLY | O_APPEND | O_CLOEXEC);
+    c->dirty = false;
+    return ok && c->indexFd >= 0;
+}
+static int ThumbCacheByAge(const void *a, const void *b)
+{
+    uint32_t x = ((const ThumbCacheRecord *)a)->lastUsed;
+    uint32_t y = ((const ThumbCacheRecord *)b)->lastUsed;
+    return (x < y) - (x > y);
+}
+static bool ThumbCacheCopy(int src, int dst, ThumbCacheRecord *r, uint64_t *dstSize)
+{
+    if (r->size == 0)
+    {
+        r->offset = *dstSize;
+        return true;
+    }
+    char *buf = malloc(r->size);
+    bool ok = buf && pread(src, buf, r->size, (off_t)r->offset) == (ssize_t)r->size &&
+              pwrite(dst, buf, r->size, (off_t)*dstSize) == (ssize_t)r->size;
+    free(buf);
+    if (!ok)
+        return false;
+    r->offset = *dstSize;
+    *dstSize += r->size;
+    return true;
+}
+static void ThumbCacheCollect(ThumbCache *c)
+{
+    pthread_mutex_lock(&c->lock);
+    uint32_t count = c->count;
+    uint64_t packEnd = c->packSize;
+    int packFd = c->packFd;
+    ThumbCacheRecord *keep = malloc((count + 1) * sizeof(ThumbCacheRecord));
+    if (keep && count)
+        memcpy(keep, c->entries, count * sizeof(ThumbCacheRecord));
+    pthread_mutex_unlock(&c->lock);
+    if (!keep)
+        return;
+    qsort(keep, count, sizeof(ThumbCacheRecord), ThumbCacheByAge);
+    uint64_t target = (uint64_t)(c->budget * THUMB_CACHE_GC_TARGET);
+    uint64_t bytes = 0;
+    uint32_t kept = 0;
+    while (kept < count && bytes + keep[kept].size <= target)
+        bytes += keep[kept++].size;
+    char tmpPath[PATH_MAX + 8];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", c->packPath);
+    int dst = open(tmpPath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    uint64_t dstSize = 0;
+    bool ok = dst >= 0;
+    for (uint32_t i = 0; ok && i < kept; i++)
+        ok = ThumbCacheCopy(packFd, dst, &keep[i], &dstSize);
+    pthread_mutex_lock(&c->lock);
+    for (uint32_t i = 0; ok && i < c->count; i++)
+    {
+        ThumbCacheRecord *r = &c->entries[i];
+        if (r->offset >= packEnd)
+        {
+            keep[kept] = *r;
+            ok = ThumbCacheCopy(c->packFd, dst, &keep[kept], &dstSize);
+            ThumbCacheRecord *grown = realloc(keep, (kept + 2) * sizeof(ThumbCacheRecord));
+            ok = ok && grown;
+            if (grown)
+                keep = grown;
+            kept++;
+        }
+    }
+    for (uint32_t i = 0; ok && i < kept; i++)
+    {
+        const ThumbCacheRecord *live = ThumbCacheFind(c, keep[i].key);
+        if (live)
+            keep[i].lastUsed = MAX(keep[i].lastUsed, live->lastUsed);
+    }
+    if (ok && fsync(dst) == 0 && rename(tmpPath, c->packPath) == 0)
+    {
+        close(c->packFd);
+        c->packFd = dst;
+        c->packSize = dstSize;
+        dst = -1;
+        ThumbCacheReset(c);
+        for (uint32_t i = 0; i < kept; i++)
+            ThumbCacheInsert(c, &keep[i]);
+        ThumbCacheWriteIndex(c);
+        TraceLog(LOG_INFO, "Thumbnail cache trimmed to %u entries (%.1f MB)", c->count, dstSize / (1024.0 * 1024.0));
+    }
+    else
+    {
+        unlink(tmpPath);
+        c->budget = MAX(c->budget, c->packSize + c->packSize / 4);
+        fprintf(stderr, "Error: Failed to compact thumbnail cache\n");
+    }
+    pthread_mutex_unlock(&c->lock);
+    if (dst >= 0)
+        close(dst);
+    free(keep);
+}
+static void *ThumbCacheGcFn(void *arg)
+{
+    ThumbCache *c = (ThumbCache *)arg;
+    pthread_mutex_lock(&c->lock);
+    while (!c->gcStopping)
+    {
+        if (c->packSize <= c->budget)
+        {
+            pthread_cond_wait(&c->wake, &c->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&c->lock);
+        ThumbCacheCollect(c);
+        pthread_mutex_lock(&c->lock);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+bool ThumbCacheOpen(ThumbCache *c, uint64_t budget)
+{
+    memset(c, 0, sizeof(*c));
+    c->packFd = c->indexFd = -1;
+    c->budget = budget;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->wake, NULL);
+    char dir[PATH_MAX];
+    if (!ThumbCacheDir(dir, sizeof(dir)))
+    {
+        fprintf(stderr, "Error: No usable thumbnail cache directory\n");
+        return false;
+    }
+    snprintf(c->packPath, sizeof(c->packPath), "%.*s/%s", PATH_MAX - 16, dir, THUMB_CACHE_PACK);
+    snprintf(c->indexPath, sizeof(c->indexPath), "%.*s/%s", PATH_MAX - 16, dir, THUMB_CACHE_INDEX);
+    c->packFd = open(c->packPath, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if (c->packFd < 0 || fstat(c->packFd, &st) != 0)
+    {
+        fprintf(stderr, "Error: Failed to open %s\n", c->packPath);
+        return false;
+    }
+    c->packSize = (uint64_t)st.st_size;
+    if (!ThumbCacheLoadIndex(c) && c->packSize > 0 && ftruncate(c->packFd, 0) == 0)
+        c->packSize = 0;
+    if (!ThumbCacheWriteIndex(c))
+        fprintf(stderr, "Error: Failed to write %s\n", c->indexPath);
+    c->gcRunning = pthread_create(&c->gcThread, NULL, ThumbCacheGcFn, c) == 0;
+    return true;
+}
+void ThumbCacheClose(ThumbCache *c)
+{
+    if (c->gcRunning)
+    {
+        pthread_mutex_lock(&c->lock);
+        c->gcStopping = true;
+        pthread_cond_signal(&c->wake);
+        pthread_mutex_unlock(&c->lock);
+        pthread_join(c->gcThread, NULL);
+    }
+    if (c->dirty && c->packFd >= 0)
+        ThumbCacheWriteIndex(c);
+    if (c->packFd >= 0)
+        close(c->packFd);
+    if (c->indexFd >= 0)
+        close(c->indexFd);
+    ThumbCacheReset(c);
+    pthread_cond_destroy(&c->wake);
+    pthread_mutex_destroy(&c->lock);
+}
+uint64_t ThumbCacheKey(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return 0;
+    int64_t parts[3] = {(int64_t)st.st_size, (int64_t)st.st_mtim.tv_sec, (int64_t)st.st_mtim.tv_nsec};
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++)
+        h = (h ^ *p) * 1099511628211ULL;
+    const unsigned char *bytes = (const unsigned char *)parts;
+    for (size_t i = 0; i < sizeof(parts); i++)
+        h = (h ^ bytes[i]) * 1099511628211ULL;
+    return h ? h : 1;
+}
+uint64_t ThumbCacheVariant(uint64_t key, uint32_t variant)
+{
+    if (key == 0 || variant == 0)
+        return key;
+    uint64_t h = key;
+    for (int i = 0; i < 4; i++)
+        h = (h ^ ((variant >> (i * 8)) & 0xFF)) * 1099511628211ULL;
+    return h ? h : 1;
+}
+bool ThumbCacheGet(ThumbCache *c, uint64_t key, Image *out)
+{
+    if (key == 0)
+        return false;
+    pthread_mutex_lock(&c->lock);
+    ThumbCacheRecord *r = c->packFd >= 0 ? ThumbCacheFind(c, key) : NULL;
+    size_t size = r ? r->size : 0;
+    uint8_t *data = size ? malloc(size) : NULL;
+    bool ok = data && pread(c->packFd, data, size, (off_t)r->offset) == (ssize_t)size;
+    if (ok)
+    {
+        r->lastUsed = (uint32_t)time(NULL);
+        c->dirty = true;
+    }
+    pthread_mutex_unlock(&c->lock);
+    int width = 0, height = 0;
+    uint8_t *pixels = ok ? QoiDecode(data, size, &width, &height) : NULL;
+    free(data);
+    if (!pixels)
+        return false;
+    *out = (Image){pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return true;
+}
+static void ThumbCacheAppend(ThumbCache *c, ThumbCacheRecord *r, const uint8_t *data)
+{
+    r->lastUsed = (uint32_t)time(NULL);
+    pthread_mutex_lock(&c->lock);
+    r->offset = c->packSize;
+    if (c->packFd >= 0 && (r->size == 0 || pwrite(c->packFd, data, r->size, (off_t)r->offset) == (ssize_t)r->size))
+    {
+        c->packSize += r->size;
+        if (ThumbCacheInsert(c, r) && c->indexFd >= 0 &&
+            write(c->indexFd, r, sizeof(*r)) != (ssize_t)sizeof(*r))
+            c->dirty = true;
+        if (c->packSize > c->budget)
+            pthread_cond_signal(&c->wake);
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+void ThumbCachePut(ThumbCache *c, uint64_t key, Image image)
+{
+    if (key == 0 || !image.data || image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+        return;
+    size_t size = 0;
+    uint8_t *data = QoiEncode(image.data, image.width, image.height, &size);
+    if (!data)
+        return;
+    ThumbCacheRecord r = {0};
+    r.key = key;
+    r.width = (uint16_t)image.width;
+    r.height = (uint16_t)image.height;
+    r.size = (uint32_t)size;
+    ThumbCacheAppend(c, &r, data);
+    free(data);
+}
+bool ThumbCacheHas(ThumbCache *c, uint64_t key)
+{
+    if (key == 0)
+        return false;
+    pthread_mutex_lock(&c->lock);
+    ThumbCacheRecord *r = c->packFd >= 0 ? ThumbCacheFind(c, key) : NULL;
+    bool found = r && r->size > 0;
+    if (found)
+    {
+        r->lastUsed = (uint32_t)time(NULL);
+        c->dirty = true;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return found;
+}
+bool ThumbCacheFailed(ThumbCache *c, uint64_t key)
+{
+    if (key == 0)
+        return false;
+    pthread_mutex_lock(&c->lock);
+    ThumbCacheRecord *r = c->packFd >= 0 ? ThumbCacheFind(c, key) : NULL;
+    bool failed = r && r->size == 0;
+    if (failed)
+    {
+        r->lastUsed = (uint32_t)time(NULL);
+        c->dirty = true;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return failed;
+}
+void ThumbCachePutFailed(ThumbCache *c, uint64_t key)
+{
+    if (key == 0)
+        return;
+    ThumbCacheRecord r = {0};
+    r.key = key;
+    ThumbCacheAppend(c, &r, NULL);
+}
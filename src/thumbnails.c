@@ -1,46 +1,946 @@
-#include "include/main.h"
-#include <limits.h>
-void GenerateOrLoadThumbnail(MediaLibrary *lib, int index)
+#include "include/thumbnails.h"
+#include "include/journal.h"
+#include "include/frame.h"
+#include <math.h>
+#include <unistd.h>
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/samplefmt.h>
+#include <libswscale/swscale.h>
+static int ThumbInterrupt(void *opaque)
 {
-    if (lib->thumbnails[index].id != 0)
+    return atomic_load(&((ThumbPool *)opaque)->stopping);
+}
+static AVCodecContext *ThumbOpenDecoder(AVFormatContext *fmt, enum AVMediaType type, int *stream)
+{
+    const AVCodec *codec = NULL;
+    *stream = av_find_best_stream(fmt, type, -1, -1, &codec, 0);
+    if (*stream < 0 || !codec)
+        return NULL;
+    AVCodecContext *dec = avcodec_alloc_context3(codec);
+    if (!dec)
+        return NULL;
+    dec->thread_count = 1;
+    if (avcodec_parameters_to_context(dec, fmt->streams[*stream]->codecpar) < 0 ||
+        avcodec_open2(dec, codec, NULL) < 0)
+        avcodec_free_context(&dec);
+    return dec;
+}
+static bool ThumbSeek(AVFormatContext *fmt, int stream, int64_t target)
+{
+    AVStream *st = fmt->streams[stream];
+    int64_t ts = av_rescale_q(target, AV_TIME_BASE_Q, st->time_base);
+    if (st->start_time != AV_NOPTS_VALUE)
+        ts += st->start_time;
+    return av_seek_frame(fmt, stream, ts, AVSEEK_FLAG_BACKWARD) >= 0;
+}
+static bool ThumbReadFrame(AVFormatContext *fmt, int stream, AVCodecContext *dec, AVFrame *frame)
+{
+    AVPacket *pkt = av_packet_alloc();
+    if (!pkt)
+        return false;
+    bool got = false;
+    while (!got && av_read_frame(fmt, pkt) >= 0)
+    {
+        if (pkt->stream_index == stream && avcodec_send_packet(dec, pkt) >= 0)
+            got = avcodec_receive_frame(dec, frame) == 0;
+        av_packet_unref(pkt);
+    }
+    if (!got && avcodec_send_packet(dec, NULL) >= 0)
+        got = avcodec_receive_frame(dec, frame) == 0;
+    av_packet_free(&pkt);
+    return got && frame->width > 0 && frame->height > 0;
+}
+static bool ThumbScale(const AVFrame *frame, int boxW, int boxH, Image *out)
+{
+    int w = boxW;
+    int h = (int)((int64_t)frame->height * w / frame->width);
+    if (h > boxH)
+    {
+        h = boxH;
+        w = (int)((int64_t)frame->width * h / frame->height);
+    }
+    w = MAX(2, w & ~1);
+    h = MAX(2, h & ~1);
+    struct SwsContext *sws = sws_getContext(frame->width, frame->height, frame->format,
+                                            w, h, AV_PIX_FMT_RGBA, SWS_BILINEAR,
+                                            NULL, NULL, NULL);
+    uint8_t *pixels = sws ? malloc((size_t)w * h * 4) : NULL;
+    if (pixels)
+    {
+        uint8_t *dst[4] = {pixels, NULL, NULL, NULL};
+        int dstStride[4] = {w * 4, 0, 0, 0};
+        sws_scale(sws, (const uint8_t *const *)frame->data, frame->linesize,
+                  0, frame->height, dst, dstStride);
+        *out = (Image){pixels, w, h, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    }
+    sws_freeContext(sws);
+    return pixels != NULL;
+}
+static bool ThumbGrabFrame(AVFormatContext *fmt, int stream, AVCodecContext *dec, AVFrame *frame, Image *out)
+{
+    int64_t target = (int64_t)THUMB_SEEK_SEC * AV_TIME_BASE;
+    if (fmt->duration != AV_NOPTS_VALUE && fmt->duration > 0 && target >= fmt->duration)
+        target = fmt->duration / 2;
+    ThumbSeek(fmt, stream, target);
+    return ThumbReadFrame(fmt, stream, dec, frame) && ThumbScale(frame, THUMB_WIDTH, THUMB_HEIGHT, out);
+}
+static bool ThumbGrabSheet(AVFormatContext *fmt, int stream, AVCodecContext *dec, AVFrame *frame, Image *out)
+{
+    if (fmt->duration == AV_NOPTS_VALUE || fmt->duration <= 0)
+        return false;
+    int sheetW = THUMB_SHEET_COLS * THUMB_WIDTH;
+    int sheetH = THUMB_SHEET_ROWS * THUMB_HEIGHT;
+    uint8_t *pixels = calloc((size_t)sheetW * sheetH, 4);
+    if (!pixels)
+        return false;
+    for (size_t i = 0; i < (size_t)sheetW * sheetH; i++)
+        pixels[i * 4 + 3] = 255;
+    int got = 0;
+    for (; got < THUMB_SHEET_FRAMES; got++)
+    {
+        Image cell = {0};
+        avcodec_flush_buffers(dec);
+        if (!ThumbSeek(fmt, stream, fmt->duration * (2 * got + 1) / (2 * THUMB_SHEET_FRAMES)) ||
+            !ThumbReadFrame(fmt, stream, dec, frame) || !ThumbScale(frame, THUMB_WIDTH, THUMB_HEIGHT, &cell))
+            break;
+        int x = got % THUMB_SHEET_COLS * THUMB_WIDTH + (THUMB_WIDTH - cell.width) / 2;
+        int y = got / THUMB_SHEET_COLS * THUMB_HEIGHT + (THUMB_HEIGHT - cell.height) / 2;
+        for (int row = 0; row < cell.height; row++)
+            memcpy(pixels + ((size_t)(y + row) * sheetW + x) * 4,
+                   (uint8_t *)cell.data + (size_t)row * cell.width * 4, (size_t)cell.width * 4);
+        free(cell.data);
+    }
+    if (got < THUMB_SHEET_FRAMES)
+    {
+        free(pixels);
+        return false;
+    }
+    *out = (Image){pixels, sheetW, sheetH, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return true;
+}
+static bool ThumbGrabTrick(AVFormatContext *fmt, int stream, AVCodecContext *dec, AVFrame *frame, int part, Image *out)
+{
+    int64_t step = (int64_t)THUMB_TRICK_SEC * AV_TIME_BASE;
+    int64_t first = (int64_t)part * THUMB_TRICK_FRAMES;
+    if (fmt->duration == AV_NOPTS_VALUE || fmt->duration <= 0 || first * step >= fmt->duration)
+        return false;
+    int count = (int)MIN(THUMB_TRICK_FRAMES, (fmt->duration + step - 1) / step - first);
+    int sheetW = THUMB_TRICK_COLS * THUMB_TRICK_W;
+    int sheetH = THUMB_TRICK_ROWS * THUMB_TRICK_H;
+    uint8_t *pixels = calloc((size_t)sheetW * sheetH, 4);
+    if (!pixels)
+        return false;
+    for (size_t i = 0; i < (size_t)sheetW * sheetH; i++)
+        pixels[i * 4 + 3] = 255;
+    int got = 0;
+    for (; got < count; got++)
+    {
+        Image cell = {0};
+        avcodec_flush_buffers(dec);
+        if (!ThumbSeek(fmt, stream, (first + got) * step) ||
+            !ThumbReadFrame(fmt, stream, dec, frame) || !ThumbScale(frame, THUMB_TRICK_W, THUMB_TRICK_H, &cell))
+            break;
+        int x = got % THUMB_TRICK_COLS * THUMB_TRICK_W + (THUMB_TRICK_W - cell.width) / 2;
+        int y = got / THUMB_TRICK_COLS * THUMB_TRICK_H + (THUMB_TRICK_H - cell.height) / 2;
+        for (int row = 0; row < cell.height; row++)
+            memcpy(pixels + ((size_t)(y + row) * sheetW + x) * 4,
+                   (uint8_t *)cell.data + (size_t)row * cell.width * 4, (size_t)cell.width * 4);
+        free(cell.data);
+    }
+    if (got < count)
+    {
+        free(pixels);
+        return false;
+    }
+    *out = (Image){pixels, sheetW, sheetH, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return true;
+}
+static bool ThumbGrabCover(AVStream *st, AVCodecContext *dec, AVFrame *frame, Image *out)
+{
+    if (avcodec_send_packet(dec, &st->attached_pic) < 0)
+        return false;
+    bool got = avcodec_receive_frame(dec, frame) == 0;
+    if (!got && avcodec_send_packet(dec, NULL) >= 0)
+        got = avcodec_receive_frame(dec, frame) == 0;
+    return got && frame->width > 0 && frame->height > 0 && ThumbScale(frame, THUMB_WIDTH, THUMB_HEIGHT, out);
+}
+static void ThumbPeaks(const float *s, int n, float *lo, float *hi)
+{
+    float l[8], h[8];
+    for (int k = 0; k < 8; k++)
+    {
+        l[k] = *lo;
+        h[k] = *hi;
+    }
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            l[k] = s[i + k] < l[k] ? s[i + k] : l[k];
+            h[k] = s[i + k] > h[k] ? s[i + k] : h[k];
+        }
+    }
+    for (; i < n; i++)
+    {
+        l[0] = s[i] < l[0] ? s[i] : l[0];
+        h[0] = s[i] > h[0] ? s[i] : h[0];
+    }
+    for (int k = 0; k < 8; k++)
+    {
+        *lo = l[k] < *lo ? l[k] : *lo;
+        *hi = h[k] > *hi ? h[k] : *hi;
+    }
+}
+static const float *ThumbSamples(const uint8_t *data, enum AVSampleFormat fmt, int n, float *buf)
+{
+    switch (fmt)
+    {
+    case AV_SAMPLE_FMT_FLT:
+        return (const float *)data;
+    case AV_SAMPLE_FMT_DBL:
+        for (int i = 0; i < n; i++)
+            buf[i] = (float)((const double *)data)[i];
+        return buf;
+    case AV_SAMPLE_FMT_S16:
+        for (int i = 0; i < n; i++)
+            buf[i] = ((const int16_t *)data)[i] * (1.0f / 32768.0f);
+        return buf;
+    case AV_SAMPLE_FMT_S32:
+        for (int i = 0; i < n; i++)
+            buf[i] = ((const int32_t *)data)[i] * (1.0f / 2147483648.0f);
+        return buf;
+    case AV_SAMPLE_FMT_U8:
+        for (int i = 0; i < n; i++)
+            buf[i] = (data[i] - 128) * (1.0f / 128.0f);
+        return buf;
+    default:
+        return NULL;
+    }
+}
+typedef struct
+{
+    int64_t total;
+    int64_t pos;
+    float   lo[THUMB_WIDTH];
+    float   hi[THUMB_WIDTH];
+    float  *scratch;
+    int     scratchLen;
+} ThumbWave;
+static bool ThumbWaveFrame(ThumbWave *w, const AVFrame *frame, int channels)
+{
+    bool planar = av_sample_fmt_is_planar(frame->format);
+    enum AVSampleFormat packed = av_get_packed_sample_fmt(frame->format);
+    int planes = planar ? channels : 1;
+    int stride = planar ? 1 : channels;
+    int n = frame->nb_samples;
+    for (int c = 0; c < planes; c++)
+    {
+        int count = n * stride;
+        if (packed != AV_SAMPLE_FMT_FLT && count > w->scratchLen)
+        {
+            float *grown = realloc(w->scratch, count * sizeof(float));
+            if (!grown)
+                return false;
+            w->scratch = grown;
+            w->scratchLen = count;
+        }
+        const float *s = ThumbSamples(frame->extended_data[c], packed, count, w->scratch);
+        if (!s)
+            return false;
+        for (int i = 0; i < n;)
+        {
+            int64_t col = MIN((w->pos + i) * THUMB_WIDTH / w->total, THUMB_WIDTH - 1);
+            int64_t next = ((col + 1) * w->total + THUMB_WIDTH - 1) / THUMB_WIDTH - w->pos;
+            int end = col == THUMB_WIDTH - 1 ? n : (int)MAX(i + 1, MIN(n, next));
+            ThumbPeaks(s + (size_t)i * stride, (end - i) * stride, &w->lo[col], &w->hi[col]);
+            i = end;
+        }
+    }
+    w->pos += n;
+    return true;
+}
+static void ThumbWaveImage(const ThumbWave *w, Image *out)
+{
+    uint8_t *pixels = malloc((size_t)THUMB_WIDTH * THUMB_HEIGHT * 4);
+    if (!pixels)
         return;
-    char thumbPath[512];
-    char safeName[128];
-    snprintf(safeName, sizeof(safeName), "%s_%08x",
-             GetFileNameWithoutExt(lib->paths[index]),
-             simple_hash(lib->paths[index]));
-    snprintf(thumbPath, sizeof(thumbPath), "/tmp/myview_%s.png", safeName);
-    if (!FileExists(thumbPath))
+    float peak = 0.0f;
+    for (int x = 0; x < THUMB_WIDTH; x++)
+        peak = MAX(peak, MAX(-w->lo[x], w->hi[x]));
+    float scale = peak > 0.0f ? (THUMB_HEIGHT / 2 - 4) / peak : 0.0f;
+    for (int x = 0; x < THUMB_WIDTH; x++)
     {
-        char command[1024];
-        snprintf(command, sizeof(command),
-                 "ffmpeg -y -ss 00:00:05 -i \"%s\" -frames:v 1 -vf scale=320:-2 -q:v 5 \"%s\" -loglevel quiet",
-                 lib->paths[index], thumbPath);
-        TraceLog(LOG_INFO, "Creating thumbnail: %s", GetFileName(lib->paths[index]));
-        int ret = system(command);
-        if (ret != 0)
+        int top = THUMB_HEIGHT / 2 - (int)(w->hi[x] * scale);
+        int bottom = THUMB_HEIGHT / 2 - (int)(w->lo[x] * scale);
+        for (int y = 0; y < THUMB_HEIGHT; y++)
         {
-            TraceLog(LOG_WARNING, "ffmpeg failed (code %d) for %s", ret, lib->paths[index]);
-            return;
+            Color c = (y >= top && y <= bottom) ? GOLD : (Color){20, 20, 24, 255};
+            memcpy(pixels + ((size_t)y * THUMB_WIDTH + x) * 4, &c, 4);
         }
     }
-    if (FileExists(thumbPath))
+    *out = (Image){pixels, THUMB_WIDTH, THUMB_HEIGHT, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+static bool ThumbGrabWave(AVFormatContext *fmt, int stream, AVCodecContext *dec, AVFrame *frame, Image *out)
+{
+    if (fmt->duration == AV_NOPTS_VALUE || fmt->duration <= 0 || dec->sample_rate <= 0)
+        return false;
+    for (unsigned i = 0; i < fmt->nb_streams; i++)
+        if ((int)i != stream)
+            fmt->streams[i]->discard = AVDISCARD_ALL;
+    ThumbWave *w = calloc(1, sizeof(ThumbWave));
+    AVPacket *pkt = w ? av_packet_alloc() : NULL;
+    if (!pkt)
+    {
+        free(w);
+        return false;
+    }
+    w->total = MAX(1, fmt->duration * dec->sample_rate / AV_TIME_BASE);
+    int channels = dec->ch_layout.nb_channels;
+    bool ok = channels > 0;
+    int ret = 0;
+    while (ok && (ret = av_read_frame(fmt, pkt)) >= 0)
     {
-        lib->thumbnails[index] = LoadTexture(thumbPath);
-        if (lib->thumbnails[index].id > 0)
+        if (pkt->stream_index == stream && avcodec_send_packet(dec, pkt) >= 0)
+            while (ok && avcodec_receive_frame(dec, frame) == 0)
+                ok = ThumbWaveFrame(w, frame, channels);
+        av_packet_unref(pkt);
+    }
+    ok = ok && ret == AVERROR_EOF && avcodec_send_packet(dec, NULL) >= 0;
+    while (ok && avcodec_receive_frame(dec, frame) == 0)
+        ok = ThumbWaveFrame(w, frame, channels);
+    if (ok && w->pos > 0)
+        ThumbWaveImage(w, out);
+    ok = ok && out->data;
+    av_packet_free(&pkt);
+    free(w->scratch);
+    free(w);
+    return ok;
+}
+static bool ThumbDecode(ThumbPool *p, const char *path, int kind, int part, Image *out)
+{
+    AVFormatContext *fmt = avformat_alloc_context();
+    if (!fmt)
+        return false;
+    fmt->interrupt_callback.callback = ThumbInterrupt;
+    fmt->interrupt_callback.opaque = p;
+    if (avformat_open_input(&fmt, path, NULL, NULL) != 0)
+        return false;
+    int stream = -1;
+    bool probed = avformat_find_stream_info(fmt, NULL) >= 0;
+    AVCodecContext *dec = probed ? ThumbOpenDecoder(fmt, AVMEDIA_TYPE_VIDEO, &stream) : NULL;
+    bool cover = dec && (fmt->streams[stream]->disposition & AV_DISPOSITION_ATTACHED_PIC);
+    AVFrame *frame = probed ? av_frame_alloc() : NULL;
+    bool ok = false;
+    if (frame && dec && !cover)
+        ok = kind == THUMB_JOB_SHEET   ? ThumbGrabSheet(fmt, stream, dec, frame, out)
+             : kind == THUMB_JOB_TRICK ? ThumbGrabTrick(fmt, stream, dec, frame, part, out)
+                                       : ThumbGrabFrame(fmt, stream, dec, frame, out);
+    else if (frame && kind == THUMB_JOB_FRAME)
+    {
+        ok = cover && ThumbGrabCover(fmt->streams[stream], dec, frame, out);
+        if (!ok)
         {
-            TraceLog(LOG_INFO, "Thumbnail ready for %s", GetFileName(lib->paths[index]));
+            avcodec_free_context(&dec);
+            dec = ThumbOpenDecoder(fmt, AVMEDIA_TYPE_AUDIO, &stream);
+            ok = dec && ThumbGrabWave(fmt, stream, dec, frame, out);
         }
+    }
+    if (!ok && kind != THUMB_JOB_TRICK && !atomic_load(&p->stopping))
+        TraceLog(LOG_WARNING, "Could not extract a %s from %s", kind == THUMB_JOB_SHEET ? "preview" : "thumbnail", path);
+    av_frame_free(&frame);
+    avcodec_free_context(&dec);
+    avformat_close_input(&fmt);
+    return ok;
+}
+static void ThumbShrink(Image image, uint8_t *rgb)
+{
+    const uint8_t *src = image.data;
+    for (int y = 0; y < PLACEHOLDER_H; y++)
+    {
+        int y0 = y * image.height / PLACEHOLDER_H;
+        int y1 = MAX(y0 + 1, (y + 1) * image.height / PLACEHOLDER_H);
+        for (int x = 0; x < PLACEHOLDER_W; x++)
+        {
+            int x0 = x * image.width / PLACEHOLDER_W;
+            int x1 = MAX(x0 + 1, (x + 1) * image.width / PLACEHOLDER_W);
+            uint32_t sum[3] = {0, 0, 0};
+            for (int sy = y0; sy < y1; sy++)
+                for (int sx = x0; sx < x1; sx++)
+                    for (int c = 0; c < 3; c++)
+                        sum[c] += src[((size_t)sy * image.width + sx) * 4 + c];
+            uint32_t n = (uint32_t)((y1 - y0) * (x1 - x0));
+            for (int c = 0; c < 3; c++)
+                *rgb++ = (uint8_t)(sum[c] / n);
+        }
+    }
+}
+static void *ThumbWorkerFn(void *arg)
+{
+    ThumbPool *p = (ThumbPool *)arg;
+    pthread_mutex_lock(&p->lock);
+    for (;;)
+    {
+        while (p->jobCount == 0 && !atomic_load(&p->stopping))
+            pthread_cond_wait(&p->jobReady, &p->lock);
+        if (atomic_load(&p->stopping))
+            break;
+        int best = 0;
+        for (int i = 1; i < p->jobCount; i++)
+        {
+            const ThumbJob *a = &p->jobs[i], *b = &p->jobs[best];
+            if (a->priority < b->priority || (a->priority == b->priority && a->seq < b->seq))
+                best = i;
+        }
+        ThumbJob job = p->jobs[best];
+        p->jobs[best] = p->jobs[--p->jobCount];
+        if (job.kind == THUMB_JOB_TRICK)
+        {
+            p->trickRunningId = job.id;
+            p->trickRunning = job.part;
+        }
+        pthread_mutex_unlock(&p->lock);
+        ThumbResult *r = calloc(1, sizeof(ThumbResult));
+        if (r)
+        {
+            r->id = job.id;
+            r->kind = job.kind;
+            r->part = job.part;
+            uint64_t key = ThumbCacheVariant(ThumbCacheKey(job.path), (uint32_t)job.kind | (uint32_t)job.part << 8);
+            r->cached = job.priority == THUMB_PRIORITY_TRICK && ThumbCacheHas(&p->cache, key);
+            if (!r->cached && !ThumbCacheGet(&p->cache, key, &r->image) && !ThumbCacheFailed(&p->cache, key))
+            {
+                if (ThumbDecode(p, job.path, job.kind, job.part, &r->image))
+                    ThumbCachePut(&p->cache, key, r->image);
+                else if (!atomic_load(&p->stopping))
+                    ThumbCachePutFailed(&p->cache, key);
+            }
+            if (r->image.data && job.kind == THUMB_JOB_FRAME)
+                ThumbShrink(r->image, r->placeholder);
+        }
+        free(job.path);
+        pthread_mutex_lock(&p->lock);
+        if (job.kind == THUMB_JOB_TRICK)
+            p->trickRunningId = MEDIA_ID_NONE;
+        if (r)
+        {
+            if (p->doneTail)
+                p->doneTail->next = r;
+            else
+                p->done = r;
+            p->doneTail = r;
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+static bool ThumbPush(ThumbPool *p, ThumbJob *job)
+{
+    if (p->jobCount == p->jobCapacity)
+    {
+        int capacity = p->jobCapacity ? p->jobCapacity * 2 : 64;
+        ThumbJob *jobs = realloc(p->jobs, capacity * sizeof(ThumbJob));
+        if (!jobs)
+            return false;
+        p->jobs = jobs;
+        p->jobCapacity = capacity;
+    }
+    job->seq = p->jobSeq++;
+    p->jobs[p->jobCount++] = *job;
+    pthread_cond_signal(&p->jobReady);
+    return true;
+}
+static bool ThumbReprioritize(ThumbPool *p, MediaId id, int kind, int priority)
+{
+    for (int i = 0; i < p->jobCount; i++)
+    {
+        ThumbJob *job = &p->jobs[i];
+        if (job->id != id || job->kind != kind)
+            continue;
+        if (job->frame != p->frame || priority < job->priority)
+            job->priority = priority;
+        job->frame = p->frame;
+        return true;
+    }
+    return false;
+}
+static void ThumbCancelStale(ThumbPool *p)
+{
+    pthread_mutex_lock(&p->lock);
+    for (int i = 0; i < p->jobCount;)
+    {
+        ThumbJob *job = &p->jobs[i];
+        if (p->frame - job->frame <= THUMB_CANCEL_FRAMES)
+        {
+            i++;
+            continue;
+        }
+        if (job->kind == THUMB_JOB_SHEET && job->id == p->sheetWanted)
+            p->sheetWanted = MEDIA_ID_NONE;
+        else if (job->kind == THUMB_JOB_FRAME && job->id < p->stateCapacity)
+            p->state[job->id] = THUMB_STATE_NONE;
+        free(job->path);
+        *job = p->jobs[--p->jobCount];
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+static uint8_t *ThumbState(ThumbPool *p, MediaId id)
+{
+    if (id >= p->stateCapacity)
+    {
+        uint32_t capacity = p->stateCapacity ? p->stateCapacity : 1024;
+        while (capacity <= id)
+            capacity *= 2;
+        uint8_t *state = realloc(p->state, capacity);
+        if (!state)
+            return NULL;
+        memset(state + p->stateCapacity, THUMB_STATE_NONE, capacity - p->stateCapacity);
+        p->state = state;
+        p->stateCapacity = capacity;
+    }
+    return &p->state[id];
+}
+void ThumbStart(AppState *g)
+{
+    ThumbPool *p = calloc(1, sizeof(ThumbPool));
+    if (!p)
+        return;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->jobReady, NULL);
+    AtlasInit(&p->atlas);
+    p->atlas.maxPages = (int)MAX(1, MIN((long)g->thumbVramMB * 1024 * 1024 / ATLAS_PAGE_BYTES, ATLAS_MAX_PAGES));
+    p->frame = 1;
+    p->sheetOwner = MEDIA_ID_NONE;
+    p->sheetWanted = MEDIA_ID_NONE;
+    p->trickOwner = MEDIA_ID_NONE;
+    p->trickId = MEDIA_ID_NONE;
+    p->trickRunningId = MEDIA_ID_NONE;
+    ThumbCacheOpen(&p->cache, (uint64_t)g->thumbCacheMB * 1024 * 1024);
+    av_log_set_level(AV_LOG_QUIET);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int want = (int)MAX(1, MIN(cpus - 1, THUMB_MAX_WORKERS));
+    for (int i = 0; i < want; i++)
+        if (pthread_create(&p->workers[p->workerCount], NULL, ThumbWorkerFn, p) == 0)
+            p->workerCount++;
+    if (p->workerCount == 0)
+        fprintf(stderr, "Error: Failed to start thumbnail workers\n");
+    g->thumbPool = p;
+}
+void ThumbRequest(AppState *g, MediaLibrary *lib, int index, int priority)
+{
+    ThumbPool *p = g->thumbPool;
+    if (!p || p->workerCount == 0 || index < 0 || index >= lib->count)
+        return;
+    MediaId id = lib->ids[index];
+    if (lib->thumbSlots[index] != THUMB_SLOT_NONE)
+    {
+        if (priority == THUMB_PRIORITY_VISIBLE)
+            AtlasTouch(&p->atlas, lib->thumbSlots[index], p->frame);
+        return;
+    }
+    uint8_t *state = ThumbState(p, id);
+    if (!state || *state == THUMB_STATE_FAILED)
+        return;
+    if (*state == THUMB_STATE_QUEUED)
+    {
+        pthread_mutex_lock(&p->lock);
+        ThumbReprioritize(p, id, THUMB_JOB_FRAME, priority);
+        pthread_mutex_unlock(&p->lock);
+        return;
+    }
+    ThumbJob job = {id, strdup(LibPath(lib, index)), priority, 0, p->frame, THUMB_JOB_FRAME, 0};
+    pthread_mutex_lock(&p->lock);
+    bool queued = job.path && ThumbPush(p, &job);
+    pthread_mutex_unlock(&p->lock);
+    if (!queued)
+    {
+        free(job.path);
+        return;
+    }
+    *state = THUMB_STATE_QUEUED;
+}
+void ThumbRequestSheet(AppState *g, MediaLibrary *lib, int index)
+{
+    ThumbPool *p = g->thumbPool;
+    if (!p || p->workerCount == 0 || index < 0 || index >= lib->count)
+        return;
+    MediaId id = lib->ids[index];
+    if (id == p->sheetOwner)
+    {
+        p->sheetWanted = id;
+        return;
+    }
+    pthread_mutex_lock(&p->lock);
+    if (id == p->sheetWanted)
+    {
+        ThumbReprioritize(p, id, THUMB_JOB_SHEET, THUMB_PRIORITY_PREFETCH);
+        pthread_mutex_unlock(&p->lock);
+        return;
+    }
+    for (int i = 0; i < p->jobCount; i++)
+    {
+        if (p->jobs[i].kind != THUMB_JOB_SHEET)
+            continue;
+        free(p->jobs[i].path);
+        p->jobs[i--] = p->jobs[--p->jobCount];
+    }
+    ThumbJob job = {id, strdup(LibPath(lib, index)), THUMB_PRIORITY_PREFETCH, 0, p->frame, THUMB_JOB_SHEET, 0};
+    if (job.path && ThumbPush(p, &job))
+        p->sheetWanted = id;
+    else
+        free(job.path);
+    pthread_mutex_unlock(&p->lock);
+}
+bool ThumbDrawSheet(AppState *g, const MediaLibrary *lib, int index, Rectangle dest, Color tint)
+{
+    ThumbPool *p = g->thumbPool;
+    if (!p || p->sheet.id == 0 || p->sheetOwner != lib->ids[index])
+        return false;
+    double t = (GetTime() - p->sheetShown) * THUMB_SHEET_FPS;
+    int frame = (int)t % THUMB_SHEET_FRAMES;
+    FrameAnimate(g, (floor(t) + 1.0 - t) / THUMB_SHEET_FPS);
+    Rectangle src = {(float)(frame % THUMB_SHEET_COLS * THUMB_WIDTH),
+                     (float)(frame / THUMB_SHEET_COLS * THUMB_HEIGHT), THUMB_WIDTH, THUMB_HEIGHT};
+    DrawTexturePro(p->sheet, src, dest, (Vector2){0, 0}, 0.0f, tint);
+    return true;
+}
+static void ThumbShowSheet(ThumbPool *p, const ThumbResult *r)
+{
+    if (r->id != p->sheetWanted)
+        return;
+    if (p->sheet.id > 0)
+        UnloadTexture(p->sheet);
+    p->sheet = r->image.data ? LoadTextureFromImage(r->image) : (Texture2D){0};
+    if (p->sheet.id > 0)
+        SetTextureFilter(p->sheet, TEXTURE_FILTER_BILINEAR);
+    p->sheetOwner = r->id;
+    p->sheetShown = GetTime();
+}
+void ThumbRequestTrick(AppState *g, const char *path, double sec)
+{
+    ThumbPool *p = g->thumbPool;
+    MediaId id = p ? ArenaFind(&g->pathArena, path) : MEDIA_ID_NONE;
+    if (!p || p->workerCount == 0 || id == MEDIA_ID_NONE)
+        return;
+    if (id != p->trickId)
+    {
+        p->trickId = id;
+        p->trickNext = 0;
+        p->trickDone = false;
+    }
+    p->trickWanted = sec >= 0.0 ? (int)(sec / THUMB_TRICK_SEC) / THUMB_TRICK_FRAMES : -1;
+    bool show = p->trickWanted >= 0 && !(p->trickOwner == id && p->trickPart == p->trickWanted);
+    if (!show && p->trickDone)
+        return;
+    int part = show ? p->trickWanted : p->trickNext;
+    int priority = show ? THUMB_PRIORITY_VISIBLE : THUMB_PRIORITY_TRICK;
+    pthread_mutex_lock(&p->lock);
+    int queued = -1;
+    for (int i = 0; i < p->jobCount; i++)
+        if (p->jobs[i].kind == THUMB_JOB_TRICK)
+            queued = i;
+    if (queued >= 0 && p->jobs[queued].id != id)
+    {
+        free(p->jobs[queued].path);
+        p->jobs[queued] = p->jobs[--p->jobCount];
+        queued = -1;
+    }
+    if (queued >= 0)
+    {
+        ThumbJob *job = &p->jobs[queued];
+        job->part = part;
+        job->priority = priority;
+        job->frame = p->frame;
+    }
+    else if (p->trickRunningId != id || p->trickRunning != part)
+    {
+        ThumbJob job = {id, strdup(path), priority, 0, p->frame, THUMB_JOB_TRICK, part};
+        if (!job.path || !ThumbPush(p, &job))
+            free(job.path);
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+bool ThumbDrawTrick(AppState *g, double sec, Rectangle dest, Color tint)
+{
+    ThumbPool *p = g->thumbPool;
+    if (!p || p->trick.id == 0 || p->trickOwner != p->trickId || sec < 0.0)
+        return false;
+    int index = (int)(sec / THUMB_TRICK_SEC);
+    if (index / THUMB_TRICK_FRAMES != p->trickPart)
+        return false;
+    int cell = index % THUMB_TRICK_FRAMES;
+    Rectangle src = {(float)(cell % THUMB_TRICK_COLS * THUMB_TRICK_W),
+                     (float)(cell / THUMB_TRICK_COLS * THUMB_TRICK_H), THUMB_TRICK_W, THUMB_TRICK_H};
+    DrawTexturePro(p->trick, src, dest, (Vector2){0, 0}, 0.0f, tint);
+    return true;
+}
+static void ThumbShowTrick(ThumbPool *p, const ThumbResult *r)
+{
+    if (r->id != p->trickId)
+        return;
+    if (r->part == p->trickNext)
+    {
+        if (r->image.data || r->cached)
+            p->trickNext++;
         else
+            p->trickDone = true;
+    }
+    if (!r->image.data || r->part != p->trickWanted)
+        return;
+    if (p->trick.id > 0)
+        UnloadTexture(p->trick);
+    p->trick = LoadTextureFromImage(r->image);
+    if (p->trick.id > 0)
+        SetTextureFilter(p->trick, TEXTURE_FILTER_BILINEAR);
+    p->trickOwner = r->id;
+    p->trickPart = r->part;
+}
+static bool ThumbEvict(AppState *g)
+{
+    ThumbPool *p = g->thumbPool;
+    int32_t slot = AtlasLeastRecent(&p->atlas, p->frame - 1);
+    if (slot == THUMB_SLOT_NONE)
+        return false;
+    MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+    for (int j = 0; j < 3; j++)
+    {
+        int idx = LibFindId(libs[j], p->atlas.owner[slot]);
+        if (idx >= 0 && libs[j]->thumbSlots[idx] == slot)
+            libs[j]->thumbSlots[idx] = THUMB_SLOT_NONE;
+    }
+    AtlasRelease(&p->atlas, slot);
+    return true;
+}
+static int32_t ThumbStore(AppState *g, MediaId id, Image image)
+{
+    ThumbPool *p = g->thumbPool;
+    int32_t slot = AtlasStore(&p->atlas, image, id, p->frame);
+    if (slot == THUMB_SLOT_NONE && ThumbEvict(g))
+        slot = AtlasStore(&p->atlas, image, id, p->frame);
+    if (slot == THUMB_SLOT_NONE && p->atlas.pageCount == p->atlas.maxPages && p->atlas.maxPages < ATLAS_MAX_PAGES)
+    {
+        p->atlas.maxPages++;
+        TraceLog(LOG_WARNING, "Visible thumbnails exceed the VRAM budget, allowing %d atlas pages", p->atlas.maxPages);
+        slot = AtlasStore(&p->atlas, image, id, p->frame);
+    }
+    return slot;
+}
+static void ThumbCell(const uint8_t *rgb, uint8_t *rgba, int stride)
+{
+    for (int y = 0; y < THUMB_CELL_H; y++)
+    {
+        const uint8_t *row = rgb + MIN(MAX(y - 1, 0), PLACEHOLDER_H - 1) * PLACEHOLDER_W * 3;
+        uint8_t *dst = rgba + (size_t)y * stride;
+        for (int x = 0; x < THUMB_CELL_W; x++)
+        {
+            const uint8_t *px = row + MIN(MAX(x - 1, 0), PLACEHOLDER_W - 1) * 3;
+            dst[x * 4 + 0] = px[0];
+            dst[x * 4 + 1] = px[1];
+            dst[x * 4 + 2] = px[2];
+            dst[x * 4 + 3] = 255;
+        }
+    }
+}
+static Rectangle ThumbCellRect(MediaId id)
+{
+    return (Rectangle){(float)(id % THUMB_CELL_COLS * THUMB_CELL_W),
+                       (float)(id / THUMB_CELL_COLS * THUMB_CELL_H), THUMB_CELL_W, THUMB_CELL_H};
+}
+static bool ThumbCellsLoad(AppState *g)
+{
+    ThumbPool *p = g->thumbPool;
+    const PlaceholderTable *t = &g->placeholders;
+    uint32_t capacity = MIN(t->capacity, THUMB_CELL_MAX);
+    uint32_t rows = (capacity + THUMB_CELL_COLS - 1) / THUMB_CELL_COLS;
+    if (rows == 0 || (p->cells.id > 0 && rows * THUMB_CELL_COLS <= p->cellCapacity))
+        return false;
+    int stride = THUMB_CELL_TEX_W * 4;
+    uint8_t *pixels = calloc((size_t)rows * THUMB_CELL_H, stride);
+    if (!pixels)
+        return false;
+    for (MediaId id = 0; id < capacity; id++)
+    {
+        const uint8_t *rgb = PlaceholderGet(t, id);
+        Rectangle cell = ThumbCellRect(id);
+        if (rgb)
+            ThumbCell(rgb, pixels + (size_t)cell.y * stride + (size_t)cell.x * 4, stride);
+    }
+    Image image = {pixels, THUMB_CELL_TEX_W, (int)(rows * THUMB_CELL_H), 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    Texture2D cells = LoadTextureFromImage(image);
+    free(pixels);
+    if (cells.id == 0)
+        return false;
+    SetTextureFilter(cells, TEXTURE_FILTER_BILINEAR);
+    if (p->cells.id > 0)
+        UnloadTexture(p->cells);
+    p->cells = cells;
+    p->cellCapacity = rows * THUMB_CELL_COLS;
+    return true;
+}
+static void ThumbCellUpdate(AppState *g, MediaId id)
+{
+    ThumbPool *p = g->thumbPool;
+    if (p->cells.id == 0)
+        return;
+    if (id >= p->cellCapacity)
+    {
+        ThumbCellsLoad(g);
+        return;
+    }
+    uint8_t rgba[THUMB_CELL_W * THUMB_CELL_H * 4];
+    ThumbCell(PlaceholderGet(&g->placeholders, id), rgba, THUMB_CELL_W * 4);
+    UpdateTextureRec(p->cells, ThumbCellRect(id), rgba);
+}
+static void ThumbKeepPlaceholder(AppState *g, MediaId id, const uint8_t *rgb)
+{
+    if (PlaceholderGet(&g->placeholders, id) || !PlaceholderSet(&g->placeholders, id, rgb))
+        return;
+    MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+    for (int j = 0; j < 3; j++)
+    {
+        int idx = LibFindId(libs[j], id);
+        if (idx >= 0)
+        {
+            JournalPlaceholder(g, libs[j], idx);
+            break;
+        }
+    }
+    ThumbCellUpdate(g, id);
+}
+static bool ThumbAttach(AppState *g, MediaId id, Image image)
+{
+    MediaLibrary *libs[] = {&g->movieLib, &g->videoLib, &g->musicLib};
+    for (int j = 0; j < 3; j++)
+    {
+        int idx = LibFindId(libs[j], id);
+        if (idx < 0 || libs[j]->thumbSlots[idx] != THUMB_SLOT_NONE)
+            continue;
+        libs[j]->thumbSlots[idx] = ThumbStore(g, id, image);
+        return libs[j]->thumbSlots[idx] != THUMB_SLOT_NONE;
+    }
+    return true;
+}
+bool ThumbDraw(AppState *g, const MediaLibrary *lib, int index, Rectangle dest, Color tint)
+{
+    ThumbPool *p = g->thumbPool;
+    int32_t slot = lib->thumbSlots[index];
+    if (!p)
+        return false;
+    if (slot == THUMB_SLOT_NONE)
+    {
+        MediaId id = lib->ids[index];
+        if (!PlaceholderGet(&g->placeholders, id))
+            return false;
+        if (p->cells.id == 0 || id >= p->cellCapacity)
+            ThumbCellsLoad(g);
+        if (p->cells.id == 0 || id >= p->cellCapacity)
+            return false;
+        Rectangle cell = ThumbCellRect(id);
+        Rectangle src = {cell.x + 1, cell.y + 1, PLACEHOLDER_W, PLACEHOLDER_H};
+        DrawTexturePro(p->cells, src, dest, (Vector2){0, 0}, 0.0f, tint);
+        return true;
+    }
+    AtlasTouch(&p->atlas, slot, p->frame);
+    DrawTexturePro(AtlasPage(&p->atlas, slot), AtlasSource(&p->atlas, slot),
+                   dest, (Vector2){0, 0}, 0.0f, tint);
+    return true;
+}
+bool ThumbHasImage(const AppState *g, const MediaLibrary *lib, int index)
+{
+    return lib->thumbSlots[index] != THUMB_SLOT_NONE || PlaceholderGet(&g->placeholders, lib->ids[index]);
+}
+void ThumbRelease(AppState *g, MediaLibrary *lib, int index)
+{
+    ThumbPool *p = g->thumbPool;
+    if (!p || lib->thumbSlots[index] == THUMB_SLOT_NONE)
+        return;
+    AtlasRelease(&p->atlas, lib->thumbSlots[index]);
+    lib->thumbSlots[index] = THUMB_SLOT_NONE;
+}
+static void ThumbShowFrame(AppState *g, const ThumbResult *r)
+{
+    ThumbPool *p = g->thumbPool;
+    if (r->image.data)
+        ThumbKeepPlaceholder(g, r->id, r->placeholder);
+    bool ok = r->image.data && ThumbAttach(g, r->id, r->image);
+    if (r->image.data && !ok)
+        TraceLog(LOG_WARNING, "Could not upload thumbnail for %s", ArenaGet(&g->pathArena, r->id));
+    if (r->id < p->stateCapacity)
+        p->state[r->id] = r->image.data ? THUMB_STATE_NONE : THUMB_STATE_FAILED;
+}
+void ThumbUpload(AppState *g)
+{
+    ThumbPool *p = g->thumbPool;
+    if (!p)
+        return;
+    if (g->frameDrawn)
+    {
+        p->frame++;
+        ThumbCancelStale(p);
+    }
+    double start = GetTime();
+    long bytes = 0;
+    long byteBudget = (long)g->thumbUploadKB * 1024;
+    for (;;)
+    {
+        pthread_mutex_lock(&p->lock);
+        ThumbResult *r = p->done;
+        if (r)
         {
-            TraceLog(LOG_WARNING, "Could not load texture %s", thumbPath);
+            p->done = r->next;
+            if (!p->done)
+                p->doneTail = NULL;
         }
+        pthread_mutex_unlock(&p->lock);
+        if (!r)
+            break;
+        if (r->kind == THUMB_JOB_SHEET)
+            ThumbShowSheet(p, r);
+        else if (r->kind == THUMB_JOB_TRICK)
+            ThumbShowTrick(p, r);
+        else
+            ThumbShowFrame(g, r);
+        FrameInvalidate(g, FRAME_THUMBS);
+        bytes += (long)r->image.width * r->image.height * 4;
+        UnloadImage(r->image);
+        free(r);
+        if (bytes >= byteBudget || (GetTime() - start) * 1000.0 >= g->thumbUploadMs)
+            break;
     }
 }
-void RefreshThumbnails(MediaLibrary *lib)
+void ThumbStop(AppState *g)
 {
-    for (int i = 0; i < lib->count; i++)
+    ThumbPool *p = g->thumbPool;
+    if (!p)
+        return;
+    pthread_mutex_lock(&p->lock);
+    atomic_store(&p->stopping, true);
+    pthread_cond_broadcast(&p->jobReady);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 0; i < p->workerCount; i++)
+        pthread_join(p->workers[i], NULL);
+    for (int i = 0; i < p->jobCount; i++)
+        free(p->jobs[i].path);
+    while (p->done)
     {
-        GenerateOrLoadThumbnail(lib, i);
+        ThumbResult *next = p->done->next;
+        UnloadImage(p->done->image);
+        free(p->done);
+        p->done = next;
     }
-}
\ No newline at end of file
+    free(p->jobs);
+    free(p->state);
+    AtlasUnload(&p->atlas);
+    if (p->cells.id > 0)
+        UnloadTexture(p->cells);
+    if (p->sheet.id > 0)
+        UnloadTexture(p->sheet);
+    if (p->trick.id > 0)
+        UnloadTexture(p->trick);
+    ThumbCacheClose(&p->cache);
+    pthread_cond_destroy(&p->jobReady);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+    g->thumbPool = NULL;
+}
@@ -1,4 +1,10 @@
 #include "include/main.h"
+#include "include/frame.h"
+#include "include/player.h"
+#include "include/journal.h"
+#include "include/persist.h"
+#include "include/thumbnails.h"
+#include "include/query.h"
 #include "rlgl.h"
 #include <math.h>
 #include "raymath.h"
@@ -16,99 +22,81 @@ while (list[count] != NULL)
 count++;
 return count;
 }
-int GetActualIndex(MediaLibrary *lib, int visibleIndex, AppState *g)
+static const char **GetLibGenreList(AppState *g, MediaLibrary *lib)
 {
-const char **list = GetActiveGenreList(g);
-int count = 0;
-for (int i = 0; i < lib->count; i++)
-{
-bool genreMatch = true;
-bool filteringActive = false;
-if (!g->selectedGenres[0]) {
-for (int j = 1; j < 32; j++) {
-if (g->selectedGenres[j]) {
-filteringActive = true;
-if (strstr(lib->genres[i], list[j]) == NULL) {
-genreMatch = false;
-break;
-}
-}
-}
+if (lib == &g->musicLib)
+return MUSIC_GENRE_LIST;
+return GENRE_LIST;
 }
-if (!filteringActive && !g->selectedGenres[0]) genreMatch = true;
-bool favMatch = !g->showFavorites || lib->isFavorite[i];
-if (genreMatch && favMatch)
+static MediaFilter BuildMediaFilter(AppState *g, MediaLibrary *lib)
 {
-if (count == visibleIndex)
-return i;
-count++;
+MediaFilter f = {0};
+f.favoritesOnly = g->showFavorites;
+if (g->selectedGenres[0])
+return f;
+const char **list = GetLibGenreList(g, lib);
+for (int j = 1; j < 32 && list[j] != NULL; j++)
+if (g->selectedGenres[j])
+FilterRequireGenre(&f, list[j]);
+return f;
 }
+static MediaView *GetGridView(AppState *g, MediaLibrary *lib)
+{
+MediaFilter f = BuildMediaFilter(g, lib);
+ViewRefresh(&g->gridView, lib, &f);
+return &g->gridView;
 }
-return -1;
+int GetActualIndex(MediaLibrary *lib, int visibleIndex, AppState *g)
+{
+return ViewAt(GetGridView(g, lib), visibleIndex);
 }
 int GetVisibleCount(MediaLibrary *lib, AppState *g)
 {
-const char **list = GetActiveGenreList(g);
-int count = 0;
-for (int i = 0; i < lib->count; i++)
-{
-bool genreMatch = false;
-bool hasSelectedGenre = false;
-if (g->activeGenreIdx == 0) {
-genreMatch = true;
-} else {
-for (int j = 1; j < 32; j++)
+return GetGridView(g, lib)->count;
+}
+static void PreviewPick(int *indices, int n, int count)
 {
-if (g->selectedGenres[j])
+for (int i = 0; i < n; i++)
 {
-hasSelectedGenre = true;
-if (strstr(lib->genres[i], list[j]) != NULL)
+int candidate;
+bool used;
+do
 {
-genreMatch = true;
-break;
-}
-}
+candidate = GetRandomValue(0, count - 1);
+used = false;
+for (int k = 0; k < i; k++)
+if (indices[k] == candidate)
+used = true;
+} while (used);
+indices[i] = candidate;
 }
-if (!hasSelectedGenre) genreMatch = true;
 }
-bool favMatch = !g->showFavorites || lib->isFavorite[i];
-if (genreMatch && favMatch)
-count++;
-}
-return count;
-}
-static void ToggleGenreInBuffer(char *buf, const char *genre)
+static void GridPrefetch(AppState *g, MediaLibrary *lib, const MediaView *view, int columns,
+int firstRow, int lastRow, float rowHeight)
 {
-if (strstr(buf, genre) != NULL)
+int totalRows = (view->count + columns - 1) / columns;
+int ahead = THUMB_PREFETCH_ROWS + (int)ceilf(fabsf(g->gridScrollTarget - g->gridScrollOffset) / rowHeight);
+int below = g->gridScrollDir > 0 ? ahead : 1;
+int above = g->gridScrollDir < 0 ? ahead : 1;
+for (int d = 1; d <= MAX(above, below); d++)
 {
-char temp[256] = "";
-char copy[256];
-strncpy(copy, buf, 255);
-copy[255] = '\0';
-char *tok = strtok(copy, ", ");
-while (tok != NULL)
+int rows[2] = {lastRow + d, firstRow - d};
+int limits[2] = {below, above};
+for (int k = 0; k < 2; k++)
 {
-if (strcmp(tok, genre) != 0)
-{
-if (strlen(temp) > 0)
-strcat(temp, ", ");
-strcat(temp, tok);
+if (d > limits[k] || rows[k] < 0 || rows[k] >= totalRows)
+continue;
+int priority = THUMB_PRIORITY_PREFETCH + (limits[k] == ahead ? d : 2 * d);
+for (int c = 0; c < columns; c++)
+ThumbRequest(g, lib, ViewAt(view, rows[k] * columns + c), priority);
 }
-tok = strtok(NULL, ", ");
 }
-strncpy(buf, temp, 31);
-buf[31] = '\0';
 }
-else
-{
-size_t need = strlen(genre) + (strlen(buf) > 0 ? 2 : 0);
-if (strlen(buf) + need < 31)
+static void ToggleItemGenre(AppState *g, MediaLibrary *lib, int index, const char *genre)
 {
-if (strlen(buf) > 0)
-strncat(buf, ", ", 31 - strlen(buf));
-strncat(buf, genre, 31 - strlen(buf));
-}
-}
+GenreId id = GenreIntern(genre);
+LibSetGenre(lib, index, id, !LibHasGenre(lib, index, id));
+JournalGenre(g, lib, index, id);
 }
 void DrawGenreGrid(AppState *g)
 {
@@ -122,8 +110,7 @@ const char **list = GetActiveGenreList(g);
 int genreCount = GetActiveGenreCount(g);
 if (g->isTaggingMode)
 {
-char *currentGenres = lib->genres[g->editingIndex];
-const char *movieName = GetFileNameWithoutExt(lib->paths[g->editingIndex]);
+const char *movieName = GetFileNameWithoutExt(LibPath(lib, g->editingIndex));
 int tagCount = genreCount - 1;
 if (IsKeyPressed(KEY_RIGHT))
 {
@@ -158,8 +145,7 @@ if (IsKeyPressed(KEY_ENTER))
 int gi = g->genreSelectedIndex + 1;
 if (gi < genreCount)
 {
-ToggleGenreInBuffer(currentGenres, list[gi]);
-SaveSettings(g);
+ToggleItemGenre(g, lib, g->editingIndex, list[gi]);
 PlaySound(g->selectSound);
 }
 }
@@ -190,7 +176,7 @@ Rectangle box = {
 tagPad + col * (boxW + tagSpacing),
 gridStartY + row * (boxH + tagSpacing),
 boxW, boxH};
-bool isTagged = strstr(currentGenres, list[gi]) != NULL;
+bool isTagged = LibHasGenre(lib, g->editingIndex, GenreFind(list[gi]));
 bool isSelected = (i == g->genreSelectedIndex);
 bool isHovered = CheckCollisionPointRec(mouse, box);
 if (isHovered && (GetMouseDelta().x != 0 || GetMouseDelta().y != 0))
@@ -218,14 +204,15 @@ DrawText("v", (int)(box.x + box.width - 24), (int)(box.y + 6), 18, GREEN);
 if (isHovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
 {
 g->genreSelectedIndex = i;
-ToggleGenreInBuffer(currentGenres, list[gi]);
-SaveSettings(g);
+ToggleItemGenre(g, lib, g->editingIndex, list[gi]);
 PlaySound(g->selectSound);
 }
 }
 DrawRectangleGradientV(0, (int)(sh - 60), (int)sw, 60,
 (Color){18, 18, 24, 0}, (Color){18, 18, 24, 255});
 DrawText("Tagged:", 40, (int)(sh - 40), 20, LIGHTGRAY);
+char currentGenres[512];
+LibGenreString(lib, g->editingIndex, currentGenres, sizeof(currentGenres));
 const char *tagDisplay = (strlen(currentGenres) > 0) ? currentGenres : "(none)";
 DrawText(tagDisplay, 120, (int)(sh - 40), 20, GOLD);
 return;
@@ -244,25 +231,8 @@ int mCols = 5;
 float mSpacing = 14.0f;
 float thumbW = (sw - pad * 2.0f - mSpacing * (mCols - 1)) / mCols;
 float thumbH = thumbW * 0.5625f;
-int filteredCount = 0;
-for (int i = 0; i < lib->count; i++)
-{
-bool match = true;
-bool filtering = false;
-if (!g->selectedGenres[0]) {
-for (int j = 1; j < 32; j++) {
-if (g->selectedGenres[j]) {
-filtering = true;
-if (strstr(lib->genres[i], list[j]) == NULL) {
-match = false;
-break;
-}
-}
-}
-}
-if (!filtering && !g->selectedGenres[0]) match = true;
-if (match) filteredCount++;
-}
+MediaView *view = GetGridView(g, lib);
+int filteredCount = view->count;
 if (!g->genreMediaFocus)
 {
 if (IsKeyPressed(KEY_RIGHT))
@@ -360,28 +330,12 @@ PlaySound(g->selectSound);
 }
 if (IsKeyPressed(KEY_ENTER) && filteredCount > 0)
 {
-int visIdx = 0;
-for (int i = 0; i < lib->count; i++)
+int i = ViewAt(view, g->genreFilteredSelectedIndex);
+if (i >= 0)
 {
-bool match = g->selectedGenres[0];
-if (!match) {
-bool anySelected = false;
-for (int j = 1; j < 32; j++) {
-if (g->selectedGenres[j]) {
-anySelected = true;
-if (strstr(lib->genres[i], list[j]) != NULL) { match = true; break; }
-}
-}
-if (!anySelected) match = true;
-}
-if (!match) continue;
-if (visIdx == g->genreFilteredSelectedIndex)
-{
-PlayVideo(g, lib->paths[i]);
+PlayVideo(g, LibPath(lib, i));
 return;
 }
-visIdx++;
-}
 }
 }
 if (IsKeyPressed(KEY_BACKSPACE))
@@ -413,17 +367,7 @@ bool isActive = g->selectedGenres[i];
 if (isHovered && !g->genreMediaFocus &&
 (GetMouseDelta().x != 0 || GetMouseDelta().y != 0))
 g->genreSelectedIndex = i;
-int cnt = 0;
-if (i == 0)
-{
-cnt = lib->count;
-}
-else
-{
-for (int m = 0; m < lib->count; m++)
-if (strstr(lib->genres[m], list[i]) != NULL)
-cnt++;
-}
+int cnt = (i == 0) ? lib->count : QueryGenreCount(lib, GenreFind(list[i]));
 Color bg = isSelected  ? (Color){60, 30, 100, 255}
 : isActive  ? (Color){30, 60, 30, 255}
 : isHovered ? (Color){45, 45, 55, 255}
@@ -487,7 +431,7 @@ DrawLineEx((Vector2){pad, sepY}, (Vector2){sw - pad, sepY}, 1.5f,
 (Color){80, 80, 110, 255});
 char filterLabel[128] = "Filtered Results";
 if (g->selectedGenres[0]) {
-snprintf(filterLabel, sizeof(filterLabel), "All  (%d items)", lib->count);
+snprintf(filterLabel, sizeof(filterLabel), "All  (%d items)", filteredCount);
 } else {
 snprintf(filterLabel, sizeof(filterLabel), "Selected Genres  (%d items)", filteredCount);
 }
@@ -499,55 +443,40 @@ DrawText("No media tagged with this genre.",
 (int)(sw / 2 - 200), (int)(mediaStartY + 30), 26, DARKGRAY);
 return;
 }
-int visIdx = 0;
-for (int i = 0; i < lib->count; i++)
+int visibleCount = 0;
+while (visibleCount < view->count &&
+mediaStartY + (visibleCount / mCols) * (thumbH + mSpacing) <= sh + thumbH)
+visibleCount++;
+for (int visIdx = 0; visIdx < visibleCount; visIdx++)
 {
-bool match = g->selectedGenres[0];
-if (!match) {
-bool anySelected = false;
-for (int j = 1; j < 32; j++) {
-if (g->selectedGenres[j]) {
-anySelected = true;
-if (strstr(lib->genres[i], list[j]) != NULL) { match = true; break; }
-}
-}
-if (!anySelected) match = true;
-}
-if (!match)
-continue;
-if (lib->thumbnails[i].id == 0)
-GenerateOrLoadThumbnail(lib, i);
-int col = visIdx % mCols;
-int row = visIdx / mCols;
-float ty = mediaStartY + row * (thumbH + mSpacing);
-if (ty > sh + thumbH)
-{
-visIdx++;
-continue;
-}
-Rectangle thumb = {pad + col * (thumbW + mSpacing), ty, thumbW, thumbH};
-bool isMediaSelected = (visIdx == g->genreFilteredSelectedIndex) && g->genreMediaFocus;
-bool isHovered = CheckCollisionPointRec(mouse, thumb);
+int i = view->items[visIdx];
+Rectangle thumb = {pad + (visIdx % mCols) * (thumbW + mSpacing),
+mediaStartY + (visIdx / mCols) * (thumbH + mSpacing), thumbW, thumbH};
+ThumbRequest(g, lib, i, THUMB_PRIORITY_VISIBLE);
 DrawRectangleRounded(thumb, 0.12f, 8, DARKGRAY);
-if (lib->thumbnails[i].id > 0)
-{
-DrawTexturePro(lib->thumbnails[i],
-(Rectangle){0, 0,
-(float)lib->thumbnails[i].width,
-(float)lib->thumbnails[i].height},
-thumb, (Vector2){0, 0}, 0.0f, WHITE);
-}
-else
-{
+if (!ThumbHasImage(g, lib, i))
 DrawText("...",
 (int)(thumb.x + thumbW / 2 - 20),
 (int)(thumb.y + thumbH / 2 - 10),
 20, LIGHTGRAY);
 }
+for (int visIdx = 0; visIdx < visibleCount; visIdx++)
+{
+Rectangle thumb = {pad + (visIdx % mCols) * (thumbW + mSpacing),
+mediaStartY + (visIdx / mCols) * (thumbH + mSpacing), thumbW, thumbH};
+ThumbDraw(g, lib, view->items[visIdx], thumb, WHITE);
+}
+for (int visIdx = 0; visIdx < visibleCount; visIdx++)
+{
+int i = view->items[visIdx];
+Rectangle thumb = {pad + (visIdx % mCols) * (thumbW + mSpacing),
+mediaStartY + (visIdx / mCols) * (thumbH + mSpacing), thumbW, thumbH};
+bool isMediaSelected = (visIdx == g->genreFilteredSelectedIndex) && g->genreMediaFocus;
+bool isHovered = CheckCollisionPointRec(mouse, thumb);
 DrawRectangleGradientV((int)thumb.x, (int)(thumb.y + thumbH - 36),
 (int)thumbW, 36,
 (Color){0, 0, 0, 0}, (Color){0, 0, 0, 210});
-const char *name = GetFileNameWithoutExt(lib->paths[i]);
+const char *name = GetFileNameWithoutExt(LibPath(lib, i));
 DrawText(name,
 (int)(thumb.x + 6),
 (int)(thumb.y + thumbH - 24),
@@ -571,7 +500,7 @@ else if (isHovered)
 {
 DrawRectangleRoundedLinesEx(thumb, 0.12f, 8, 2.0f, SKYBLUE);
 }
-if (lib->isFavorite[i])
+if (LibIsFavorite(lib, i))
 DrawText("*", (int)(thumb.x + thumbW - 20), (int)(thumb.y + 5), 20, GOLD);
 if (isHovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
 {
@@ -589,7 +518,6 @@ g->genreFilteredSelectedIndex = visIdx;
 g->genreMediaFocus = true;
 PlaySound(g->selectSound);
 }
-visIdx++;
 }
 }
 void DrawMainMenu(AppState *g)
@@ -634,7 +562,11 @@ g->logoAnimatingOut = false;
 bool shouldHide = (GetTime() - g->lastActivityTime > 10.0);
 float targetVis = shouldHide ? 0.0f : 1.0f;
 float speed = shouldHide ? 0.4f : 5.0f;
-g->logoVisibility = Lerp(g->logoVisibility, targetVis, GetFrameTime() * speed);
+g->logoVisibility = Lerp(g->logoVisibility, targetVis, g->frameDt * speed);
+if (fabsf(g->logoVisibility - targetVis) > 0.01f)
+FrameInvalidate(g, FRAME_ANIMATION);
+else if (!shouldHide)
+FrameInvalidateAt(g, g->lastActivityTime + 10.0);
 float visibleY = 1.0f;
 float hiddenY = 0.3f;
 float animatedY = Lerp(hiddenY, visibleY, g->logoVisibility);
@@ -647,7 +579,10 @@ logoCamera.up = (Vector3){0.0f, 1.0f, 0.0f};
 logoCamera.fovy = 5.0f;
 logoCamera.projection = CAMERA_PERSPECTIVE;
 if (g->logoVisibility > 0.05f)
-g->logoRotY += GetFrameTime() * 30.0f;
+{
+g->logoRotY += g->frameDt * 30.0f;
+FrameAnimate(g, 0.0);
+}
 BeginMode3D(logoCamera);
 DrawModelEx(g->logoModel, g->logoPos,
 (Vector3){0.0f, 1.0f, 0.0f}, g->logoRotY,
@@ -679,6 +614,7 @@ colorDefault  = (Color){139,  90,  43, 160};
 }
 Color bg = selected ? colorSelected : hovered ? colorHovered : colorDefault;
 float waveOffset = sinf(GetTime() * 2.0f + i * 0.5f) * 1.0f;
+FrameAnimate(g, 0.0);
 Rectangle waveBtn = btn;
 waveBtn.y += waveOffset;
 DrawRectangleRounded(waveBtn, 0.25f, 12, bg);
@@ -722,23 +658,25 @@ if (now - g->lastPreviewRefresh >= 5.0 || g->lastPreviewRefresh == 0.0)
 {
 g->lastPreviewRefresh = now;
 g->fadeAlpha = 0.0f;
-bool used[256] = {0};
+bool nextReady = true;
 for (int i = 0; i < numToShow; i++)
-{
-int candidate;
-do
-{
-candidate = GetRandomValue(0, previewLib->count - 1);
-} while (used[candidate]);
-g->previewIndices[i] = candidate;
-used[candidate] = true;
-}
+if (g->previewNext[i] < 0 || g->previewNext[i] >= previewLib->count)
+nextReady = false;
+if (nextReady)
+memcpy(g->previewIndices, g->previewNext, sizeof(g->previewIndices));
+else
+PreviewPick(g->previewIndices, numToShow, previewLib->count);
+PreviewPick(g->previewNext, numToShow, previewLib->count);
 }
+FrameAnimate(g, g->lastPreviewRefresh + 5.0 - now);
+for (int i = 0; i < numToShow; i++)
+ThumbRequest(g, previewLib, g->previewNext[i], THUMB_PRIORITY_PREFETCH);
 if (g->fadeAlpha < 1.0f)
 {
-g->fadeAlpha += GetFrameTime() * 1.8f;
+g->fadeAlpha += g->frameDt * 1.8f;
 if (g->fadeAlpha > 1.0f)
 g->fadeAlpha = 1.0f;
+FrameInvalidate(g, FRAME_ANIMATION);
 }
 float paddingX = 40.0f;
 float pSpacing = 20.0f;
@@ -761,22 +699,29 @@ DrawRectangleRounded(er, 0.18f, 10, BLACK);
 continue;
 }
 int mediaIndex = g->previewIndices[idx];
-if (previewLib->thumbnails[mediaIndex].id == 0)
-GenerateOrLoadThumbnail(previewLib, mediaIndex);
+if (mediaIndex < 0 || mediaIndex >= previewLib->count)
+mediaIndex = idx;
+g->previewIndices[idx] = mediaIndex;
+ThumbRequest(g, previewLib, mediaIndex, THUMB_PRIORITY_VISIBLE);
 Rectangle r = {startX + col * (thumbW + pSpacing),
 startY + row * (thumbH + pSpacing),
 thumbW, thumbH};
 DrawRectangleRounded(r, 0.18f, 10, BLACK);
-if (previewLib->thumbnails[mediaIndex].id > 0)
+}
+}
+for (int idx = 0; idx < numToShow; idx++)
 {
-DrawTexturePro(previewLib->thumbnails[mediaIndex],
-(Rectangle){0, 0,
-(float)previewLib->thumbnails[mediaIndex].width,
-(float)previewLib->thumbnails[mediaIndex].height},
-r, (Vector2){0, 0}, 0.0f,
-Fade(WHITE, g->fadeAlpha));
+Rectangle r = {startX + (idx % cols) * (thumbW + pSpacing),
+startY + (idx / cols) * (thumbH + pSpacing),
+thumbW, thumbH};
+ThumbDraw(g, previewLib, g->previewIndices[idx], r, Fade(WHITE, g->fadeAlpha));
 }
-const char *name = GetFileNameWithoutExt(previewLib->paths[mediaIndex]);
+for (int idx = 0; idx < numToShow; idx++)
+{
+Rectangle r = {startX + (idx % cols) * (thumbW + pSpacing),
+startY + (idx / cols) * (thumbH + pSpacing),
+thumbW, thumbH};
+const char *name = GetFileNameWithoutExt(LibPath(previewLib, g->previewIndices[idx]));
 DrawText(name,
 (int)(r.x + 12),
 (int)(r.y + thumbH - 34),
@@ -784,7 +729,6 @@ DrawText(name,
 }
 }
 }
-}
 void UpdateMainMenu(AppState *g)
 {
 Vector2 mouse = GetMousePosition();
@@ -868,16 +812,6 @@ PlaySound(g->selectSound);
 }
 }
 }
-int GetFilteredCount(MediaLibrary *lib, const char *targetGenre)
-{
-if (strcmp(targetGenre, "All") == 0)
-return lib->count;
-int count = 0;
-for (int i = 0; i < lib->count; i++)
-if (strcmp(lib->genres[i], targetGenre) == 0)
-count++;
-return count;
-}
 void DrawMediaGrid(AppState *g, MediaLibrary *lib, const char *title)
 {
 float sw = (float)GetScreenWidth();
@@ -889,7 +823,8 @@ float padding = 30.0f;
 float cardW = (sw - (padding * (columns + 1))) / columns;
 float cardH = cardW * 0.5625f;
 float rowHeight = cardH + padding;
-int totalCount = GetVisibleCount(lib, g);
+MediaView *view = GetGridView(g, lib);
+int totalCount = view->count;
 rlPushMatrix();
 rlTranslatef(0, -g->gridScrollOffset, 0);
 float startX = padding;
@@ -898,32 +833,24 @@ int firstVisibleRow = (int)floor(g->gridScrollOffset / rowHeight) - 1;
 int lastVisibleRow = (int)ceil((g->gridScrollOffset + sh) / rowHeight) + 1;
 int visibleStart = MAX(0, firstVisibleRow * columns);
 int visibleEnd = MIN(totalCount - 1, lastVisibleRow * columns + columns - 1);
-for (int visIdx = visibleStart; visIdx <= visibleEnd && visIdx < totalCount; visIdx++)
+GridPrefetch(g, lib, view, columns, firstVisibleRow, lastVisibleRow, rowHeight);
+for (int visIdx = visibleStart; visIdx <= visibleEnd; visIdx++)
 {
-int actualIdx = GetActualIndex(lib, visIdx, g);
+int actualIdx = ViewAt(view, visIdx);
 if (actualIdx < 0)
 continue;
-if (lib->thumbnails[actualIdx].id == 0)
-GenerateOrLoadThumbnail(lib, actualIdx);
+ThumbRequest(g, lib, actualIdx, THUMB_PRIORITY_VISIBLE);
 int col = visIdx % columns;
 int row = visIdx / columns;
-float x = startX + col * (cardW + padding);
-float y = startY + row * rowHeight;
-Rectangle card = {x, y, cardW, cardH};
+Rectangle card = {startX + col * (cardW + padding), startY + row * rowHeight, cardW, cardH};
 bool isSelected = (visIdx == g->selectedIndex);
+if (isSelected)
+ThumbRequestSheet(g, lib, actualIdx);
 bool isHovered = CheckCollisionPointRec(GetMousePosition(), card);
 Color bg = isSelected ? MAROON : (isHovered ? DARKGRAY : GRAY);
 DrawRectangleRounded(card, 0.15f, 8, bg);
 DrawRectangleRoundedLines(card, 0.15f, 8, isSelected ? YELLOW : WHITE);
-if (lib->thumbnails[actualIdx].id > 0)
-{
-DrawTexturePro(lib->thumbnails[actualIdx],
-(Rectangle){0, 0,
-(float)lib->thumbnails[actualIdx].width,
-(float)lib->thumbnails[actualIdx].height},
-card, (Vector2){0, 0}, 0, WHITE);
-}
-else
+if (!ThumbHasImage(g, lib, actualIdx))
 {
 DrawRectangleRec(card, DARKGRAY);
 DrawText("...",
@@ -931,7 +858,28 @@ DrawText("...",
 (int)(card.y + cardH / 2 - 20),
 40, WHITE);
 }
-const char *displayName = GetFileNameWithoutExt(lib->paths[actualIdx]);
+}
+for (int visIdx = visibleStart; visIdx <= visibleEnd; visIdx++)
+{
+int actualIdx = ViewAt(view, visIdx);
+if (actualIdx < 0)
+continue;
+int col = visIdx % columns;
+int row = visIdx / columns;
+Rectangle card = {startX + col * (cardW + padding), startY + row * rowHeight, cardW, cardH};
+if (visIdx != g->selectedIndex || !ThumbDrawSheet(g, lib, actualIdx, card, WHITE))
+ThumbDraw(g, lib, actualIdx, card, WHITE);
+}
+for (int visIdx = visibleStart; visIdx <= visibleEnd; visIdx++)
+{
+int actualIdx = ViewAt(view, visIdx);
+if (actualIdx < 0)
+continue;
+int col = visIdx % columns;
+int row = visIdx / columns;
+Rectangle card = {startX + col * (cardW + padding), startY + row * rowHeight, cardW, cardH};
+bool isHovered = CheckCollisionPointRec(GetMousePosition(), card);
+const char *displayName = GetFileNameWithoutExt(LibPath(lib, actualIdx));
 float fontSize = 32.0f;
 Vector2 textPos = {card.x + 25, card.y + cardH - 45};
 Vector2 shadowPos = {textPos.x + 2, textPos.y + 2};
@@ -999,16 +947,22 @@ PlaySound(g->selectSound);
 if (CheckCollisionPointRec(mouse, addBtn))
 {
 char *path = OpenFileDialog();
-if (path && IsValidMediaFile(path) && lib->count < MAX_MEDIA_FILES)
+int before = lib->count;
+int added = (path && IsValidMediaFile(path)) ? LibAdd(lib, path) : -1;
+if (added >= 0)
 {
-strncpy(lib->paths[lib->count], path, MAX_PATH_LENGTH - 1);
-lib->paths[lib->count][MAX_PATH_LENGTH - 1] = '\0';
-lib->count++;
-GenerateOrLoadThumbnail(lib, lib->count - 1);
-SaveSettings(g);
-int newTotalCount = GetVisibleCount(lib, g);
+if (lib->count > before)
+{
+ThumbRequest(g, lib, added, THUMB_PRIORITY_VISIBLE);
+JournalAdd(g, lib, added);
+}
+MediaView *view = GetGridView(g, lib);
+int newTotalCount = view->count;
 g->selectedIndex = newTotalCount - 1;
-int newRow = (newTotalCount - 1) / columns;
+for (int v = 0; v < view->count; v++)
+if (view->items[v] == added)
+g->selectedIndex = v;
+int newRow = g->selectedIndex / columns;
 float targetY = newRow * rowHeight;
 g->gridScrollOffset = MAX(0.0f, targetY - sh * 0.3f);
 }
@@ -1043,7 +997,7 @@ DrawText("Options", popupRect.x + 90, popupRect.y + 20, 30, WHITE);
 int idx = g->currentMediaIndex;
 const char *opts[5] = {
 "Play",
-lib->isFavorite[idx] ? "Unfavorite" : "Favorite",
+LibIsFavorite(lib, idx) ? "Unfavorite" : "Favorite",
 "Move", "TAG", "Delete"};
 for (int opt = 0; opt < 5; opt++)
 {
@@ -1190,16 +1144,10 @@ if (IsKeyPressed(KEY_ENTER))
 if (g->optionsSelectedIndex == 0)
 {
 int idx = g->currentMediaIndex;
-if (lib->thumbnails[idx].id > 0)
-UnloadTexture(lib->thumbnails[idx]);
-for (int i = idx; i < lib->count - 1; i++)
-{
-strcpy(lib->paths[i], lib->paths[i + 1]);
-lib->thumbnails[i] = lib->thumbnails[i + 1];
-lib->isFavorite[i] = lib->isFavorite[i + 1];
-}
-lib->count--;
-SaveSettings(g);
+MediaId id = lib->ids[idx];
+ThumbRelease(g, lib, idx);
+if (LibRemove(lib, idx))
+JournalRemove(g, lib, id);
 int newTotalCount = GetVisibleCount(lib, g);
 if (g->selectedIndex >= newTotalCount)
 g->selectedIndex = MAX(0, newTotalCount - 1);
@@ -1231,26 +1179,10 @@ if (IsKeyPressed(KEY_ENTER))
 {
 int idx = g->currentMediaIndex;
 MediaLibrary *dest = moveTargets[g->moveMenuSelectedIndex];
-if (dest->count < MAX_MEDIA_FILES)
-{
-strncpy(dest->paths[dest->count], lib->paths[idx], MAX_PATH_LENGTH - 1);
-dest->paths[dest->count][MAX_PATH_LENGTH - 1] = '\0';
-strncpy(dest->genres[dest->count], lib->genres[idx], 31);
-dest->genres[dest->count][31] = '\0';
-dest->isFavorite[dest->count] = lib->isFavorite[idx];
-dest->thumbnails[dest->count] = lib->thumbnails[idx];
-dest->count++;
-lib->thumbnails[idx] = (Texture2D){0};
-for (int i = idx; i < lib->count - 1; i++)
-{
-strcpy(lib->paths[i],    lib->paths[i + 1]);
-strcpy(lib->genres[i],   lib->genres[i + 1]);
-lib->thumbnails[i]  = lib->thumbnails[i + 1];
-lib->isFavorite[i]  = lib->isFavorite[i + 1];
-}
-lib->thumbnails[lib->count - 1] = (Texture2D){0};
-lib->count--;
-SaveSettings(g);
+int moved = LibMove(lib, idx, dest);
+if (moved >= 0)
+{
+JournalMove(g, lib, dest, moved);
 int newTotalCount = GetVisibleCount(lib, g);
 if (g->selectedIndex >= newTotalCount)
 g->selectedIndex = MAX(0, newTotalCount - 1);
@@ -1273,11 +1205,11 @@ int idx = g->currentMediaIndex;
 switch (g->optionsSelectedIndex)
 {
 case 0:
-PlayVideo(g, lib->paths[idx]);
+PlayVideo(g, LibPath(lib, idx));
 break;
 case 1:
-lib->isFavorite[idx] = !lib->isFavorite[idx];
-SaveSettings(g);
+LibSetFavorite(lib, idx, !LibIsFavorite(lib, idx));
+JournalFavorite(g, lib, idx);
 break;
 case 2:
 g->showingMoveMenu = true;
@@ -1324,7 +1256,12 @@ float selectedY = (g->selectedIndex / columns) * cardH;
 float targetOffset = selectedY - GetScreenHeight() * 0.3f;
 if (targetOffset < 0)
 targetOffset = 0;
+if (targetOffset != g->gridScrollTarget)
+g->gridScrollDir = targetOffset > g->gridScrollTarget ? 1 : -1;
+g->gridScrollTarget = targetOffset;
 g->gridScrollOffset += (targetOffset - g->gridScrollOffset) * 0.25f;
+if (fabsf(targetOffset - g->gridScrollOffset) > 0.5f)
+FrameInvalidate(g, FRAME_ANIMATION);
 if (totalCount > 0 && g->selectedIndex >= totalCount)
 g->selectedIndex = totalCount - 1;
 Vector2 mouse = GetMousePosition();
@@ -1347,15 +1284,24 @@ g->lastMouseMoveTime = now;
 bool mouseActive = (now - g->lastMouseMoveTime < 3.0);
 float targetAlpha = mouseActive ? 1.0f : 0.0f;
 g->seekBarAlpha += (targetAlpha - g->seekBarAlpha) * 0.15f;
-double timePos = 0.0;
-double duration = 0.0;
-mpv_get_property(g->mpv, "time-pos", MPV_FORMAT_DOUBLE, &timePos);
-mpv_get_property(g->mpv, "duration", MPV_FORMAT_DOUBLE, &duration);
-g->videoTimePos = timePos;
-g->videoDuration = duration;
+if (fabsf(targetAlpha - g->seekBarAlpha) > 0.01f)
+FrameInvalidate(g, FRAME_ANIMATION);
+else if (mouseActive)
+FrameInvalidateAt(g, g->lastMouseMoveTime + 3.0);
+double duration = g->videoDuration;
+PlayerSeekUpdate(g);
+g->trickHoverSec = -1.0;
 if (duration <= 0)
 return;
-g->seekProgress = (float)(timePos / duration);
+int seekDir = IsKeyDown(KEY_RIGHT) ? 1 : IsKeyDown(KEY_LEFT) ? -1 : 0;
+if (IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_LEFT) ||
+(seekDir != 0 && now - g->seekLastStep >= PLAYER_SEEK_REPEAT))
+{
+PlayerSeekStep(g, seekDir);
+g->lastMouseMoveTime = now;
+}
+if ((IsKeyReleased(KEY_RIGHT) || IsKeyReleased(KEY_LEFT)) && seekDir == 0)
+PlayerSeek(g, g->seekTarget, true);
 float sw = (float)GetScreenWidth();
 float barY = GetScreenHeight() - 100.0f;
 float barH = 8.0f;
@@ -1367,13 +1313,20 @@ if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && (overBar || g->isSeeking))
 g->isSeeking = true;
 float seekX = Clamp(mouse.x, barRect.x, barRect.x + barRect.width);
 float newProgress = (seekX - barRect.x) / barRect.width;
-char seekStr[64];
-snprintf(seekStr, sizeof(seekStr), "%.3f", newProgress * duration);
-const char *cmd[] = {"seek", seekStr, "absolute", NULL};
-mpv_command(g->mpv, cmd);
+PlayerSeek(g, newProgress * duration, false);
 }
-if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT))
+if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT) && g->isSeeking)
+{
 g->isSeeking = false;
+PlayerSeek(g, g->seekTarget, true);
+}
+g->seekProgress = (float)(PlayerPosition(g) / duration);
+Rectangle hoverRect = {barRect.x, barRect.y - 12, barRect.width, barH + 24};
+if (g->isSeeking || CheckCollisionPointRec(mouse, hoverRect))
+g->trickHoverSec = Clamp((mouse.x - barRect.x) / barRect.width, 0.0f, 1.0f) * duration;
+else if (seekDir != 0 || g->seekPending || g->seekInFlight)
+g->trickHoverSec = g->seekTarget;
+ThumbRequestTrick(g, g->currentVideoPath, g->trickHoverSec);
 }
 void DrawPlayer(AppState *g)
 {
@@ -1385,19 +1338,29 @@ mpv_opengl_fbo fbo = {.fbo = 0, .w = (int)sw, .h = (int)sh, .internal_format = 0
 mpv_render_param params[] = {
 {MPV_RENDER_PARAM_OPENGL_FBO, &fbo},
 {MPV_RENDER_PARAM_FLIP_Y, &(int){1}},
+{MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &(int){g->playerFrameReady}},
 {0}};
+double renderStart = GetTime();
 mpv_render_context_render(g->mpv_ctx, params);
+if (g->playerFrameReady)
+g->frameBlocked += GetTime() - renderStart;
+g->playerFrameReady = false;
+g->playerRendered = true;
 rlDrawRenderBatchActive();
 rlDisableBackfaceCulling();
 rlDisableDepthTest();
 rlEnableColorBlend();
 DrawRectangle(0, sh - 80, sw, 80, (Color){20, 20, 20, 200});
 DrawText(GetFileName(g->currentVideoPath), 20, sh - 60, 20, GOLD);
-double timePos = 0;
-mpv_get_property(g->mpv, "time-pos", MPV_FORMAT_DOUBLE, &timePos);
 char timeBuffer[64];
-sprintf(timeBuffer, "Time: %.0f sec", timePos);
+sprintf(timeBuffer, "Time: %.0f sec", PlayerPosition(g));
 DrawText(timeBuffer, sw - 200, sh - 60, 20, WHITE);
+if (g->playerBuffering)
+{
+char cacheBuffer[64];
+snprintf(cacheBuffer, sizeof(cacheBuffer), "Buffering %d%%", g->playerCachePercent);
+DrawText(cacheBuffer, sw - 420, sh - 60, 20, ORANGE);
+}
 if (g->seekBarAlpha > 0.05f)
 {
 float barY = GetScreenHeight() - 100.0f;
@@ -1413,9 +1376,26 @@ DrawCircle((int)knobX, (int)(barRect.y + barH / 2), knobR,
 Fade(YELLOW, g->seekBarAlpha));
 DrawCircleLines((int)knobX, (int)(barRect.y + barH / 2), knobR,
 Fade(WHITE, g->seekBarAlpha));
+if (g->trickHoverSec >= 0.0 && g->videoDuration > 0)
+{
+float pw = THUMB_TRICK_W * 1.5f;
+float ph = THUMB_TRICK_H * 1.5f;
+float px = barRect.x + barRect.width * (float)(g->trickHoverSec / g->videoDuration) - pw / 2;
+Rectangle preview = {Clamp(px, barRect.x, barRect.x + barRect.width - pw), barY - ph - 24, pw, ph};
+if (ThumbDrawTrick(g, g->trickHoverSec, preview, Fade(WHITE, g->seekBarAlpha)))
+{
+DrawRectangleLinesEx(preview, 2.0f, Fade(WHITE, g->seekBarAlpha));
+char hoverTime[32];
+snprintf(hoverTime, sizeof(hoverTime), "%02d:%02d",
+(int)(g->trickHoverSec / 60), (int)g->trickHoverSec % 60);
+DrawText(hoverTime, (int)(preview.x + 6), (int)(preview.y + ph - 22), 18,
+Fade(WHITE, g->seekBarAlpha));
+}
+}
 char curTime[32], totTime[32];
+double shownPos = PlayerPosition(g);
 snprintf(curTime, sizeof(curTime), "%02d:%02d",
-(int)(g->videoTimePos / 60), (int)g->videoTimePos % 60);
+(int)(shownPos / 60), (int)shownPos % 60);
 snprintf(totTime, sizeof(totTime), "%02d:%02d",
 (int)(g->videoDuration / 60), (int)g->videoDuration % 60);
 DrawText(curTime, (int)(barRect.x - 60), (int)(barY + 10), 20,
@@ -1424,7 +1404,7 @@ DrawText(totTime, (int)(barRect.x + barRect.width + 10), (int)(barY + 10), 20,
 Fade(WHITE, g->seekBarAlpha));
 }
 }
-#define SETTINGS_BTN_COUNT 7
+#define SETTINGS_BTN_COUNT 8
 static const char *SETTINGS_BTN_LABELS[SETTINGS_BTN_COUNT] = {
 "CHANGE THEME",
 "AUDIO SETTINGS",
@@ -1432,9 +1412,18 @@ static const char *SETTINGS_BTN_LABELS[SETTINGS_BTN_COUNT] = {
 "LIBRARY PATHS",
 "LANGUAGE",
 "ABOUT",
-"IMPORT ALL MP4"
+"IMPORT ALL MP4",
+"EXPORT SETTINGS"
 };
 static const char *THEME_OPTIONS[] = { "DEFAULT THEME", "DARK THEME", NULL };
+static void SettingsRequestExport(AppState *g)
+{
+if (atomic_load(&g->settingsExport) == PERSIST_EXPORT_PENDING)
+return;
+g->settingsExportTime = 0.0;
+PersistRequestExport(g);
+PlaySound(g->selectSound);
+}
 void UpdateSettings(AppState *g)
 {
 float btnX  = 60.0f, btnY0 = 180.0f, btnW = 340.0f, btnH = 64.0f, gap = 16.0f;
@@ -1447,6 +1436,14 @@ GetTime() - g->importFinishedTime > 10.0)
 {
 g->importDone         = false;
 g->importFinishedTime = 0.0;
+FrameInvalidate(g, FRAME_IMPORT);
+}
+if (atomic_load(&g->settingsExport) >= PERSIST_EXPORT_SAVED && g->settingsExportTime == 0.0)
+g->settingsExportTime = GetTime();
+if (g->settingsExportTime > 0.0 && GetTime() - g->settingsExportTime > 3.0)
+{
+atomic_store(&g->settingsExport, PERSIST_EXPORT_IDLE);
+g->settingsExportTime = 0.0;
 }
 if (!g->settingsPanelOpen)
 {
@@ -1472,6 +1469,8 @@ if (IsKeyPressed(KEY_ENTER) && g->settingsSelectedBtn == 6 && !g->importRunning)
 ImportAllMp4(g);
 PlaySound(g->selectSound);
 }
+if (IsKeyPressed(KEY_ENTER) && g->settingsSelectedBtn == 7)
+SettingsRequestExport(g);
 if (IsKeyPressed(KEY_BACKSPACE) || IsKeyPressed(KEY_ESCAPE))
 {
 g->currentScreen     = STATE_MAIN_MENU;
@@ -1496,7 +1495,7 @@ if (IsKeyPressed(KEY_ENTER))
 {
 g->currentTheme      = g->settingsPanelIdx;
 g->settingsPanelOpen = false;
-SaveUserSettings(g);
+PersistMarkDirty(g, PERSIST_USER_SETTINGS);
 PlaySound(g->selectSound);
 }
 if (IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_BACKSPACE)
@@ -1529,6 +1528,8 @@ else if (i == 6 && !g->importRunning)
 ImportAllMp4(g);
 PlaySound(g->selectSound);
 }
+else if (i == 7)
+SettingsRequestExport(g);
 }
 }
 }
@@ -1550,7 +1551,7 @@ if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
 g->currentTheme      = i;
 g->settingsPanelIdx  = i;
 g->settingsPanelOpen = false;
-SaveUserSettings(g);
+PersistMarkDirty(g, PERSIST_USER_SETTINGS);
 PlaySound(g->selectSound);
 }
 }
@@ -1639,6 +1640,16 @@ DrawText("ENTER to scan",
 (int)(r.x + r.width - 148),
 (int)(r.y + r.height / 2 - 9),
 16, (Color){100, 200, 120, 200});
+else if (i == 7 && atomic_load(&g->settingsExport) != PERSIST_EXPORT_IDLE)
+{
+int exportState = atomic_load(&g->settingsExport);
+bool pending = exportState == PERSIST_EXPORT_PENDING;
+FrameInvalidateAt(g, pending ? GetTime() + 0.1 : g->settingsExportTime + 3.0);
+DrawText(pending ? "saving..." : exportState == PERSIST_EXPORT_SAVED ? "saved" : "export failed",
+(int)(r.x + r.width - 148),
+(int)(r.y + r.height / 2 - 9),
+16, exportState == PERSIST_EXPORT_FAILED ? RED : GREEN);
+}
 else if (i > 0 && i < 6)
 DrawText("(coming soon)",
 (int)(r.x + r.width - 148),
@@ -1711,6 +1722,7 @@ Fade(YELLOW, 0.85f));
 }
 if (g->importRunning || g->importDone)
 {
+FrameInvalidateAt(g, GetTime() + (g->importRunning ? 1.0 / 3.0 : 0.5));
 float panelX = btnX + btnW + 40.0f;
 float panelY = btnY0 + 6 * (btnH + gap);
 float panelW = 460.0f;
@@ -0,0 +1,66 @@
+#ifndef CHECK_H
+#define CHECK_H
+#include "include/main.h"
+#include "include/store.h"
+#include <stdlib.h>
+#include <unistd.h>
+static int  checkFailures;
+static char checkDir[] = "/tmp/myview-test-XXXXXX";
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            checkFailures++;                                                         \
+        }                                                                            \
+    } while (0)
+static inline void CheckEnterTempDir(void)
+{
+    if (!mkdtemp(checkDir) || chdir(checkDir) != 0)
+    {
+        fprintf(stderr, "Error: Could not create a temporary directory\n");
+        exit(1);
+    }
+    SetTraceLogLevel(LOG_ERROR);
+}
+static inline void CheckLeaveTempDir(void)
+{
+    if (chdir("/") != 0 || rmdir(checkDir) != 0)
+        fprintf(stderr, "Warning: Could not remove %s\n", checkDir);
+}
+static inline void CheckStateInit(AppState *g)
+{
+    memset(g, 0, sizeof(*g));
+    ArenaInit(&g->pathArena);
+    NameIndexInit(&g->nameIndex, &g->pathArena);
+    LibInit(&g->movieLib, &g->pathArena, &g->nameIndex);
+    LibInit(&g->videoLib, &g->pathArena, &g->nameIndex);
+    LibInit(&g->musicLib, &g->pathArena, &g->nameIndex);
+    pthread_mutex_init(&g->libLock, NULL);
+    pthread_mutex_init(&g->persistLock, NULL);
+    pthread_cond_init(&g->persistCond, NULL);
+    g->journalFd = -1;
+}
+static inline void CheckStateFree(AppState *g)
+{
+    LibFree(&g->movieLib);
+    LibFree(&g->videoLib);
+    LibFree(&g->musicLib);
+    NameIndexFree(&g->nameIndex);
+    ArenaFree(&g->pathArena);
+    PlaceholderFree(&g->placeholders);
+    StoreClose(g);
+    pthread_cond_destroy(&g->persistCond);
+    pthread_mutex_destroy(&g->persistLock);
+    pthread_mutex_destroy(&g->libLock);
+}
+static inline int CheckReport(const char *name)
+{
+    if (checkFailures)
+        fprintf(stderr, "%s: %d checks failed\n", name, checkFailures);
+    else
+        printf("%s: ok\n", name);
+    return checkFailures ? 1 : 0;
+}
+#endif
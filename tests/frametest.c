@@ -0,0 +1,126 @@
+#define GetTime                FrameTestTime
+#define GetMouseDelta          FrameTestMouseDelta
+#define GetMouseWheelMove      FrameTestWheel
+#define IsWindowResized        FrameTestResized
+#define IsMouseButtonDown      FrameTestButton
+#define IsMouseButtonReleased  FrameTestButton
+#define IsKeyPressed           FrameTestKey
+#define IsKeyReleased          FrameTestKeyReleased
+#define PollInputEvents        FrameTestPollInput
+#include "src/frame.c"
+#include "tests/check.h"
+static double frameTestNow = 100.0;
+static int    frameTestKey = -1;
+double FrameTestTime(void) { return frameTestNow; }
+Vector2 FrameTestMouseDelta(void) { return (Vector2){0, 0}; }
+float FrameTestWheel(void) { return 0.0f; }
+bool FrameTestResized(void) { return false; }
+bool FrameTestButton(int button) { (void)button; return false; }
+bool FrameTestKey(int key) { return key == frameTestKey; }
+bool FrameTestKeyReleased(int key) { (void)key; return false; }
+void FrameTestPollInput(void) {}
+static double FrameTestClock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+static void FrameTestInit(AppState *g)
+{
+    memset(g, 0, sizeof(*g));
+    g->idleTimeoutSec = FRAME_IDLE_SEC;
+    g->idleFps = FRAME_IDLE_FPS;
+    g->frameLastInput = frameTestNow;
+    g->frameLastDraw = frameTestNow;
+    FrameStart(g);
+}
+static void FrameTestInvalidate(void)
+{
+    AppState g;
+    FrameTestInit(&g);
+    FramePoll(&g);
+    CHECK(!FrameBegin(&g));
+    FrameInvalidate(&g, FRAME_THUMBS);
+    frameTestNow += 1.0;
+    CHECK(FrameBegin(&g));
+    CHECK(g.frameDirty == 0);
+    CHECK(g.frameDt == FRAME_MAX_DT);
+    CHECK(g.frameLastDraw == frameTestNow);
+    CHECK(!FrameBegin(&g));
+    frameTestKey = KEY_DOWN;
+    FramePoll(&g);
+    frameTestKey = -1;
+    CHECK(g.frameDirty & FRAME_INPUT);
+    CHECK(g.frameLastInput == frameTestNow);
+    frameTestNow += 0.01;
+    CHECK(FrameBegin(&g));
+    CHECK(g.frameDt > 0.009f && g.frameDt < 0.011f);
+}
+static void FrameTestWakeAt(void)
+{
+    AppState g;
+    FrameTestInit(&g);
+    FrameInvalidateAt(&g, frameTestNow + 2.0);
+    FrameInvalidateAt(&g, frameTestNow + 0.5);
+    FrameInvalidateAt(&g, frameTestNow + 1.0);
+    CHECK(g.frameWakeAt == frameTestNow + 0.5);
+    frameTestNow += 0.25;
+    CHECK(!FrameBegin(&g));
+    frameTestNow += 0.5;
+    CHECK(FrameBegin(&g));
+    CHECK(g.frameWakeAt == 0.0);
+    CHECK(!FrameBegin(&g));
+}
+static void FrameTestIdle(void)
+{
+    AppState g;
+    FrameTestInit(&g);
+    CHECK(!FrameIdle(&g));
+    FrameAnimate(&g, 0.1);
+    CHECK(g.frameWakeAt == frameTestNow + 0.1);
+    g.frameWakeAt = 0.0;
+    frameTestNow += FRAME_IDLE_SEC + 1.0;
+    CHECK(FrameIdle(&g));
+    FrameAnimate(&g, 0.1);
+    CHECK(g.frameWakeAt == 0.0);
+    frameTestKey = KEY_ENTER;
+    FramePoll(&g);
+    frameTestKey = -1;
+    CHECK(!FrameIdle(&g));
+}
+static void *FrameTestWaker(void *arg)
+{
+    usleep(50000);
+    FrameWake((AppState *)arg);
+    return NULL;
+}
+static void FrameTestWait(void)
+{
+    AppState g;
+    FrameTestInit(&g);
+    FramePoll(&g);
+    double start = FrameTestClock();
+    FrameEnd(&g, true);
+    CHECK(FrameTestClock() - start < 0.005);
+    FrameEnd(&g, false);
+    double waited = FrameTestClock() - start;
+    CHECK(waited > 0.5 / FRAME_ACTIVE_FPS && waited < 0.25);
+    frameTestNow += FRAME_IDLE_SEC + 1.0;
+    g.idleFps = 1;
+    FramePoll(&g);
+    pthread_t waker;
+    start = FrameTestClock();
+    CHECK(pthread_create(&waker, NULL, FrameTestWaker, &g) == 0);
+    FrameEnd(&g, false);
+    waited = FrameTestClock() - start;
+    pthread_join(waker, NULL);
+    CHECK(waited > 0.03 && waited < 0.5);
+}
+int main(void)
+{
+    FrameTestInvalidate();
+    FrameTestWakeAt();
+    FrameTestIdle();
+    FrameTestWait();
+    return CheckReport("frame");
+}
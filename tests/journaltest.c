@@ -0,0 +1,92 @@
+#include "tests/check.h"
+#include "include/journal.h"
+#include <sys/stat.h>
+static off_t JournalTestSize(void)
+{
+    struct stat st;
+    return stat(JOURNAL_FILE, &st) == 0 ? st.st_size : -1;
+}
+static void JournalTestWrite(off_t *afterSecond, off_t *full)
+{
+    AppState g;
+    CheckStateInit(&g);
+    JournalOpen(&g);
+    CHECK(g.journalFd >= 0);
+    int a = LibAdd(&g.movieLib, "/media/a.mp4");
+    JournalAdd(&g, &g.movieLib, a);
+    int b = LibAdd(&g.movieLib, "/media/b.mp4");
+    JournalAdd(&g, &g.movieLib, b);
+    CHECK(JournalFlush(&g));
+    *afterSecond = JournalTestSize();
+    LibSetFavorite(&g.movieLib, a, true);
+    JournalFavorite(&g, &g.movieLib, a);
+    int moved = LibMove(&g.movieLib, b, &g.musicLib);
+    CHECK(moved >= 0);
+    JournalMove(&g, &g.movieLib, &g.musicLib, moved);
+    CHECK(JournalFlush(&g));
+    *full = JournalTestSize();
+    JournalClose(&g);
+    CheckStateFree(&g);
+}
+static void JournalTestReplayAll(void)
+{
+    AppState g;
+    CheckStateInit(&g);
+    CHECK(JournalOpen(&g) == 4);
+    CHECK(g.movieLib.count == 1 && g.musicLib.count == 1);
+    CHECK(LibIsFavorite(&g.movieLib, LibFind(&g.movieLib, "/media/a.mp4")));
+    CHECK(LibFind(&g.musicLib, "/media/b.mp4") == 0);
+    JournalClose(&g);
+    CheckStateFree(&g);
+}
+static void JournalTestTornTail(off_t afterSecond, off_t full)
+{
+    CHECK(truncate(JOURNAL_FILE, full - 5) == 0);
+    AppState g;
+    CheckStateInit(&g);
+    CHECK(JournalOpen(&g) == 3);
+    CHECK(g.movieLib.count == 2 && g.musicLib.count == 0);
+    CHECK(LibIsFavorite(&g.movieLib, LibFind(&g.movieLib, "/media/a.mp4")));
+    CHECK(JournalTestSize() < full - 5 && JournalTestSize() > afterSecond);
+    CHECK((size_t)JournalTestSize() == g.journalSize);
+    int c = LibAdd(&g.videoLib, "/media/c.mp4");
+    JournalAdd(&g, &g.videoLib, c);
+    CHECK(JournalFlush(&g));
+    JournalClose(&g);
+    CheckStateFree(&g);
+    CheckStateInit(&g);
+    CHECK(JournalOpen(&g) == 4);
+    CHECK(g.movieLib.count == 2 && g.videoLib.count == 1);
+    JournalClose(&g);
+    CheckStateFree(&g);
+}
+static void JournalTestCorruptRecord(off_t afterSecond)
+{
+    FILE *f = fopen(JOURNAL_FILE, "r+b");
+    CHECK(f != NULL);
+    if (!f)
+        return;
+    fseek(f, afterSecond + (off_t)sizeof(JournalRecord), SEEK_SET);
+    fputc('X', f);
+    fclose(f);
+    AppState g;
+    CheckStateInit(&g);
+    CHECK(JournalOpen(&g) == 2);
+    CHECK(g.movieLib.count == 2 && !LibIsFavorite(&g.movieLib, 0));
+    CHECK(JournalTestSize() == afterSecond);
+    JournalClose(&g);
+    CheckStateFree(&g);
+}
+int main(void)
+{
+    CheckEnterTempDir();
+    off_t afterSecond = 0, full = 0;
+    JournalTestWrite(&afterSecond, &full);
+    CHECK(afterSecond > 0 && full > afterSecond);
+    JournalTestReplayAll();
+    JournalTestTornTail(afterSecond, full);
+    JournalTestCorruptRecord(afterSecond);
+    unlink(JOURNAL_FILE);
+    CheckLeaveTempDir();
+    return CheckReport("journal");
+}
@@ -0,0 +1,90 @@
+#include "tests/check.h"
+#include "include/qoi.h"
+static uint8_t *QoiTestImage(int w, int h)
+{
+    uint8_t *px = malloc((size_t)w * h * 4);
+    if (!px)
+        return NULL;
+    srand(7);
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+        {
+            uint8_t *p = px + ((size_t)y * w + x) * 4;
+            if (y < h / 4)
+            {
+                p[0] = 20;
+                p[1] = 40;
+                p[2] = 60;
+                p[3] = 255;
+            }
+            else if (y < h / 2)
+            {
+                p[0] = (uint8_t)(x * 3);
+                p[1] = (uint8_t)(y * 2);
+                p[2] = (uint8_t)(x + y);
+                p[3] = 255;
+            }
+            else
+            {
+                p[0] = (uint8_t)rand();
+                p[1] = (uint8_t)rand();
+                p[2] = (uint8_t)rand();
+                p[3] = (uint8_t)(x & 1 ? 255 : rand());
+            }
+        }
+    return px;
+}
+static void QoiTestRoundTrip(int w, int h)
+{
+    uint8_t *src = QoiTestImage(w, h);
+    CHECK(src != NULL);
+    if (!src)
+        return;
+    size_t len = 0;
+    uint8_t *enc = QoiEncode(src, w, h, &len);
+    CHECK(enc != NULL);
+    CHECK(len >= QOI_HEADER_SIZE + QOI_PADDING);
+    int dw = 0, dh = 0;
+    uint8_t *dec = enc ? QoiDecode(enc, len, &dw, &dh) : NULL;
+    CHECK(dec != NULL);
+    CHECK(dw == w && dh == h);
+    if (dec)
+        CHECK(memcmp(src, dec, (size_t)w * h * 4) == 0);
+    free(dec);
+    free(enc);
+    free(src);
+}
+static void QoiTestRejects(void)
+{
+    int w = 64, h = 36;
+    uint8_t *src = QoiTestImage(w, h);
+    size_t len = 0;
+    uint8_t *enc = src ? QoiEncode(src, w, h, &len) : NULL;
+    CHECK(enc != NULL);
+    if (!enc)
+    {
+        free(src);
+        return;
+    }
+    int dw, dh;
+    CHECK(QoiDecode(enc, QOI_HEADER_SIZE, &dw, &dh) == NULL);
+    CHECK(QoiDecode(enc, len / 2, &dw, &dh) == NULL);
+    enc[0] = 'x';
+    CHECK(QoiDecode(enc, len, &dw, &dh) == NULL);
+    enc[0] = 'q';
+    memset(enc + 4, 0, 4);
+    CHECK(QoiDecode(enc, len, &dw, &dh) == NULL);
+    memset(enc + 4, 0xff, 8);
+    CHECK(QoiDecode(enc, len, &dw, &dh) == NULL);
+    CHECK(QoiDecode(NULL, 0, &dw, &dh) == NULL);
+    free(enc);
+    free(src);
+}
+int main(void)
+{
+    QoiTestRoundTrip(1, 1);
+    QoiTestRoundTrip(320, 180);
+    QoiTestRoundTrip(97, 13);
+    QoiTestRejects();
+    return CheckReport("qoi");
+}
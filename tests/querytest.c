@@ -0,0 +1,99 @@
+#include "tests/check.h"
+#define QUERY_TEST_ITEMS 300
+static bool QueryTestMatch(const MediaLibrary *lib, const MediaFilter *f, int i)
+{
+    if (f->matchNone)
+        return false;
+    bool any = f->anyOf == 0;
+    for (GenreId k = 0; k < MAX_GENRES; k++)
+    {
+        bool has = LibHasGenre(lib, i, k);
+        if ((f->allOf >> k & 1) && !has)
+            return false;
+        if ((f->noneOf >> k & 1) && has)
+            return false;
+        if ((f->anyOf >> k & 1) && has)
+            any = true;
+    }
+    return any && (!f->favoritesOnly || LibIsFavorite(lib, i));
+}
+static void QueryTestFilter(const MediaLibrary *lib, const MediaFilter *f)
+{
+    int expected[QUERY_TEST_ITEMS];
+    int count = 0;
+    for (int i = 0; i < lib->count; i++)
+        if (QueryTestMatch(lib, f, i))
+            expected[count++] = i;
+    CHECK(QueryCount(lib, f) == count);
+    int pos = 0;
+    for (int i = QueryNext(lib, f, 0); i >= 0; i = QueryNext(lib, f, i + 1))
+        CHECK(pos < count && expected[pos++] == i);
+    CHECK(pos == count);
+    for (int n = 0; n < count; n++)
+        CHECK(QueryNth(lib, f, n) == expected[n]);
+    CHECK(QueryNth(lib, f, count) == -1);
+    CHECK(QueryNth(lib, f, -1) == -1);
+    MediaView v = {0};
+    ViewRefresh(&v, lib, f);
+    CHECK(v.count == count);
+    for (int n = 0; n < count && n < v.count; n++)
+        CHECK(ViewAt(&v, n) == expected[n]);
+    CHECK(ViewAt(&v, count) == -1);
+    ViewFree(&v);
+}
+int main(void)
+{
+    AppState g;
+    CheckStateInit(&g);
+    MediaLibrary *lib = &g.movieLib;
+    GenreId action = GenreIntern("Action");
+    GenreId comedy = GenreIntern("Comedy");
+    GenreId horror = GenreIntern("Horror");
+    char path[64];
+    for (int i = 0; i < QUERY_TEST_ITEMS; i++)
+    {
+        snprintf(path, sizeof(path), "/media/%03d.mp4", i);
+        int idx = LibAdd(lib, path);
+        if (i % 2 == 0)
+            LibSetGenre(lib, idx, action, true);
+        if (i % 3 == 0)
+            LibSetGenre(lib, idx, comedy, true);
+        if (i % 7 == 0 || i == QUERY_TEST_ITEMS - 1)
+            LibSetGenre(lib, idx, horror, true);
+        if (i % 5 == 0 || i == 63 || i == 64)
+            LibSetFavorite(lib, idx, true);
+    }
+    CHECK(lib->count == QUERY_TEST_ITEMS);
+    CHECK(QueryGenreCount(lib, action) == QUERY_TEST_ITEMS / 2);
+    CHECK(QueryGenreCount(lib, GENRE_NONE) == 0);
+    MediaFilter filters[8];
+    memset(filters, 0, sizeof(filters));
+    filters[1].allOf = 1ull << action;
+    filters[2].allOf = (1ull << action) | (1ull << comedy);
+    filters[3].anyOf = (1ull << comedy) | (1ull << horror);
+    filters[4].allOf = 1ull << action;
+    filters[4].noneOf = 1ull << comedy;
+    filters[5].favoritesOnly = true;
+    filters[6].anyOf = 1ull << horror;
+    filters[6].noneOf = 1ull << action;
+    filters[6].favoritesOnly = true;
+    FilterRequireGenre(&filters[7], "No Such Genre");
+    CHECK(filters[7].matchNone);
+    for (int i = 0; i < 8; i++)
+        QueryTestFilter(lib, &filters[i]);
+    CHECK(QueryCount(lib, &filters[0]) == QUERY_TEST_ITEMS);
+    CHECK(QueryCount(lib, &filters[7]) == 0);
+    LibRemove(lib, 0);
+    LibRemove(lib, 64);
+    for (int i = 0; i < 8; i++)
+        QueryTestFilter(lib, &filters[i]);
+    MediaView v = {0};
+    ViewRefresh(&v, lib, &filters[1]);
+    int before = v.count;
+    LibSetGenre(lib, 1, action, !LibHasGenre(lib, 1, action));
+    ViewRefresh(&v, lib, &filters[1]);
+    CHECK(v.count != before);
+    ViewFree(&v);
+    CheckStateFree(&g);
+    return CheckReport("query");
+}
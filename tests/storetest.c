@@ -0,0 +1,97 @@
+#include "tests/check.h"
+static char  *storeImage;
+static size_t storeSize;
+static void StoreTestSave(void)
+{
+    AppState g;
+    CheckStateInit(&g);
+    GenreId drama = GenreIntern("Drama");
+    int a = LibAdd(&g.movieLib, "/media/a.mp4");
+    LibAdd(&g.movieLib, "/media/b.mp4");
+    int c = LibAdd(&g.musicLib, "/media/c.mp4");
+    LibSetFavorite(&g.movieLib, a, true);
+    LibSetGenre(&g.musicLib, c, drama, true);
+    storeImage = StoreBuild(&g, 0, &storeSize);
+    CHECK(storeImage != NULL);
+    CHECK(StoreSave(&g, CATALOG_FILE, 0));
+    CheckStateFree(&g);
+}
+static void StoreTestLoad(void)
+{
+    AppState g;
+    CheckStateInit(&g);
+    CHECK(StoreLoad(&g, CATALOG_FILE, 0));
+    CHECK(g.movieLib.count == 2 && g.videoLib.count == 0 && g.musicLib.count == 1);
+    int a = LibFind(&g.movieLib, "/media/a.mp4");
+    CHECK(a >= 0 && LibIsFavorite(&g.movieLib, a));
+    CHECK(LibFind(&g.movieLib, "/media/b.mp4") >= 0);
+    int c = LibFind(&g.musicLib, "/media/c.mp4");
+    CHECK(c >= 0 && LibHasGenre(&g.musicLib, c, GenreFind("Drama")));
+    CheckStateFree(&g);
+}
+static CatalogRecord *StoreTestRecords(char *image)
+{
+    CatalogHeader *h = (CatalogHeader *)image;
+    size_t off = sizeof(CatalogHeader) + ((size_t)h->genreCount + h->stringCount) * 4;
+    return (CatalogRecord *)(image + ((off + 7) & ~(size_t)7));
+}
+static void StoreTestReseal(char *image, size_t size)
+{
+    CatalogHeader *h = (CatalogHeader *)image;
+    h->checksum = StoreChecksum(image + sizeof(CatalogHeader), size - sizeof(CatalogHeader));
+}
+static void StoreTestRejects(const char *what, const char *image, size_t size)
+{
+    CHECK(StoreWrite(CATALOG_FILE, image, size));
+    AppState g;
+    CheckStateInit(&g);
+    bool loaded = StoreLoad(&g, CATALOG_FILE, 0);
+    if (loaded)
+        fprintf(stderr, "storetest: accepted %s\n", what);
+    CHECK(!loaded);
+    CHECK(g.movieLib.count == 0 && g.musicLib.count == 0 && g.storeMap == NULL);
+    CheckStateFree(&g);
+}
+static void StoreTestCorrupt(void)
+{
+    char *image = malloc(storeSize);
+    if (!image)
+        return;
+    CatalogHeader *h = (CatalogHeader *)image;
+    memcpy(image, storeImage, storeSize);
+    image[storeSize - 2] ^= 0x20;
+    StoreTestRejects("a flipped string byte", image, storeSize);
+    memcpy(image, storeImage, storeSize);
+    StoreTestRejects("a truncated file", image, storeSize - 8);
+    memcpy(image, storeImage, storeSize);
+    image[0] = 'X';
+    StoreTestRejects("a bad magic", image, storeSize);
+    memcpy(image, storeImage, storeSize);
+    h->genreCount = MAX_GENRES + 1;
+    StoreTestRejects("too many genres", image, storeSize);
+    memcpy(image, storeImage, storeSize);
+    StoreTestRecords(image)[0].path = 0;
+    StoreTestReseal(image, storeSize);
+    StoreTestRejects("a path aliasing a genre name", image, storeSize);
+    memcpy(image, storeImage, storeSize);
+    StoreTestRecords(image)[1].path = h->stringCount;
+    StoreTestReseal(image, storeSize);
+    StoreTestRejects("a path past the string table", image, storeSize);
+    memcpy(image, storeImage, storeSize);
+    StoreTestRecords(image)[2].library = 3;
+    StoreTestReseal(image, storeSize);
+    StoreTestRejects("an unknown library", image, storeSize);
+    free(image);
+}
+int main(void)
+{
+    CheckEnterTempDir();
+    StoreTestSave();
+    StoreTestLoad();
+    if (storeImage)
+        StoreTestCorrupt();
+    free(storeImage);
+    unlink(CATALOG_FILE);
+    CheckLeaveTempDir();
+    return CheckReport("store");
+}